@@ -14,6 +14,7 @@ from .util import *
 from .kalman import KalmanFilter
 from .singleton import Singleton
 from .loop_tracker import LoopTracker
+from .payloads import NO_ANGLE
 from .teensy_serial import TeensySerial
 
 
@@ -73,6 +74,12 @@ class MemoryManager:
                 "ball": 50,
                 "goal": 200,
             },
+            "ego_motion": {
+                # cm/s per unit of commanded velocity, measure it before enabling
+                # compensation for the robot's movement (turning is always on)
+                "speed_scaler": 0,
+                "timeout": 0.1,  # in s, after which the Teensy's data is ignored
+            },
             "test": {
                 "a": 1,
                 "b": 1,
@@ -99,6 +106,9 @@ class MemoryManager:
         self.blue_goal = None  # (angle, distance)
         self.yellow_goal = None  # (angle, distance)
         self.new_detections = threading.Condition()  # either ball or goals are updated
+        # Robot motion received by ReceivePayloadThread
+        self.robot_motion = None  # CoralRXPayload
+        self.robot_motion_time = None
         # Debug values used by AnnotateFrameProcess
         self.debug_values = {
             "cropped_frame": None,
@@ -118,6 +128,7 @@ class MemoryManager:
             "detect_ball": LoopTracker(),
             "detect_goals": LoopTracker(),
             "send_payload": LoopTracker(),
+            "receive_payload": LoopTracker(),
             "annotate_frame": LoopTracker(),
         }
         # Debug results returned by AnnotateFrameProcess
@@ -128,6 +139,22 @@ class MemoryManager:
         }
         self.new_debug_results = threading.Condition()
 
+    def get_robot_motion(self) -> Tuple[float, Tuple[float, float]]:
+        """
+        Return the robot's heading (in degrees, None if unknown) and velocity
+        (dx, dy) relative to its front (in cm/s), as last sent by the Teensy.
+        """
+
+        motion, motion_time = self.robot_motion, self.robot_motion_time
+        params = self.params["ego_motion"]
+        if motion is None or time.time() - motion_time > params["timeout"]:
+            return None, (0, 0)
+
+        heading = motion.heading / 100 if motion.heading != NO_ANGLE else None
+        speed = motion.movement_velocity * params["speed_scaler"]
+        velocity = polar_to_cartesian(motion.movement_angle / 100, speed)
+        return heading, velocity
+
 
 class Camera(metaclass=Singleton):
     """
@@ -153,8 +180,14 @@ class Camera(metaclass=Singleton):
         # These processes detect the ball and two goals
         self._detect_ball_thread = DetectBallThread(self.mem, self._stop_event)
         self._detect_goals_thread = DetectGoalsThread(self.mem, self._stop_event)
-        # This process sends out the payload to the Teensy
-        self._send_payload_thread = SendPayloadThread(self.mem, self._stop_event)
+        # These processes send out the payload to the Teensy and receive its payload
+        self._teensy_serial = TeensySerial()
+        self._send_payload_thread = SendPayloadThread(
+            self.mem, self._stop_event, self._teensy_serial
+        )
+        self._receive_payload_thread = ReceivePayloadThread(
+            self.mem, self._stop_event, self._teensy_serial
+        )
         # This process annotates the frame with the detected objects, and is created
         # everytime a new websocket is created, and ends after the websocket closes
         self._annotate_frame_thread = AnnotateFrameThread(
@@ -173,6 +206,7 @@ class Camera(metaclass=Singleton):
         self._detect_ball_thread.start()
         self._detect_goals_thread.start()
         self._send_payload_thread.start()
+        self._receive_payload_thread.start()
         self._annotate_frame_thread.start()
 
     def stop(self) -> None:
@@ -202,7 +236,9 @@ class Camera(metaclass=Singleton):
         self._detect_ball_thread.join()
         self._detect_goals_thread.join()
         self._send_payload_thread.join()
+        self._receive_payload_thread.join()
         self._annotate_frame_thread.join()
+        self._teensy_serial.close()
 
     def start_annotating(self):
         """Start the AnnotateFrameProcess."""
@@ -482,10 +518,11 @@ class DetectBallThread(threading.Thread):
             # Update state of Kalman filter
             z = np.array([[dx], [dy], [a * 2], [b * 2]], dtype=np.float)
             self._ball_filter.update(z)
-        # Predict the ball position if it has been found recently
+        # Predict the ball position if it has been found recently, compensating for
+        # the robot's own motion
         filtered_ball: Tuple[float, float] = None
         if self._ball_not_found_count <= self.mem.params["filter_endurance"]["ball"]:
-            state = self._ball_filter.predict()
+            state = self._ball_filter.predict(*self.mem.get_robot_motion())
             if state is not None:  # state might be None if it's the initial prediction
                 dx, dy = state[0][0], state[1][0]
                 # Check that the state values make sense (they are wonky sometimes)
@@ -624,13 +661,15 @@ class DetectGoalsThread(threading.Thread):
             # Update state of Kalman filter
             z = np.array([[dx], [dy], [a], [b]], dtype=np.float)
             self._blue_goal_filter.update(z)
-        # Predict the blue goal position if it has been found recently
+        # Predict the blue goal position if it has been found recently, compensating
+        # for the robot's own motion
+        heading, velocity = self.mem.get_robot_motion()
         filtered_blue_goal: Tuple[float, float] = None
         if (
             self._blue_goal_not_found_count
             <= self.mem.params["filter_endurance"]["goal"]
         ):
-            state = self._blue_goal_filter.predict()
+            state = self._blue_goal_filter.predict(heading, velocity)
             if state is not None:  # state might be None if it's the initial prediction
                 dx, dy = state[0][0], state[1][0]
                 # Check that the state values make sense (they are wonky sometimes)
@@ -654,13 +693,14 @@ class DetectGoalsThread(threading.Thread):
             # Update state of Kalman filter
             z = np.array([[dx], [dy], [a], [b]], dtype=np.float)
             self._yellow_goal_filter.update(z)
-        # Predict the yellow goal position if it has been found recently
+        # Predict the yellow goal position if it has been found recently,
+        # compensating for the robot's own motion
         filtered_yellow_goal: Tuple[float, float] = None
         if (
             self._yellow_goal_not_found_count
             <= self.mem.params["filter_endurance"]["goal"]
         ):
-            state = self._yellow_goal_filter.predict()
+            state = self._yellow_goal_filter.predict(heading, velocity)
             if state is not None:  # state might be None if it's the initial prediction
                 dx, dy = state[0][0], state[1][0]
                 # Check that the state values make sense (they are wonky sometimes)
@@ -685,13 +725,15 @@ class DetectGoalsThread(threading.Thread):
 
 
 class SendPayloadThread(threading.Thread):
-    def __init__(self, mem: MemoryManager, stop_event: threading.Event) -> None:
+    def __init__(
+        self, mem: MemoryManager, stop_event: threading.Event, serial: TeensySerial
+    ) -> None:
         super().__init__()
         self.mem = mem
         self.stop_event = stop_event
 
         # Serial manager
-        self._serial = TeensySerial()
+        self._serial = serial
 
     def run(self) -> None:
         while not self.stop_event.is_set():
@@ -718,7 +760,33 @@ class SendPayloadThread(threading.Thread):
             )
 
             self.mem.loop_trackers["send_payload"].stop_iteration()
-        self._serial.close()
+
+
+class ReceivePayloadThread(threading.Thread):
+    def __init__(
+        self, mem: MemoryManager, stop_event: threading.Event, serial: TeensySerial
+    ) -> None:
+        super().__init__()
+        self.mem = mem
+        self.stop_event = stop_event
+
+        # Serial manager
+        self._serial = serial
+
+    def run(self) -> None:
+        while not self.stop_event.is_set():
+            # Wait for the robot's motion (times out so that we can stop)
+            motion = self._serial.read_packet()
+            if motion is None:
+                continue
+
+            self.mem.loop_trackers["receive_payload"].start_iteration()
+
+            # Propagate robot motion
+            self.mem.robot_motion = motion
+            self.mem.robot_motion_time = time.time()
+
+            self.mem.loop_trackers["receive_payload"].stop_iteration()
 
 
 class AnnotateFrameThread(threading.Thread):
@@ -794,6 +862,14 @@ class AnnotateFrameThread(threading.Thread):
                 f"{t['send_payload'].mean_loop_time():5.1f} "
                 f"{t['annotate_frame'].mean_loop_time():5.1f} (ms)\n\n"
             )
+            # ROBOT
+            text += f"ROBOT ({t['receive_payload'].mean_fps():5.1f} packets/s)\n"
+            heading, (dx, dy) = self.mem.get_robot_motion()
+            if heading is not None:
+                text += f"Heading  : {heading:7.2f}º\n"
+            else:
+                text += f"Heading  :   None\n"
+            text += f"Velocity : {dx:7.2f} {dy:7.2f} cm/s\n\n"
             # BALL
             text += f"BALL\n"
             if raw_ball:
@@ -1,4 +1,7 @@
+import math
 import time
+from typing import Tuple
+
 import numpy as np
 
 
@@ -19,11 +22,21 @@ class KalmanFilter:
         self.x = None
 
         self._last_time = None
+        self._last_heading = None
+
+    def predict(
+        self, heading: float = None, velocity: Tuple[float, float] = (0, 0)
+    ) -> np.ndarray:
+        """
+        Predict the state, compensating for the robot's own motion given its heading
+        (in degrees, None if unknown) and velocity (dx, dy) relative to its front (in
+        cm/s), so that what stays still on the field stays still in the state.
+        """
 
-    def predict(self) -> np.ndarray:
         # Compute dt at each prediction step
         if self._last_time is None:
             self._last_time = time.time()
+            self._last_heading = heading
             return None
         current_time = time.time()
         dt = current_time - self._last_time
@@ -34,6 +47,23 @@ class KalmanFilter:
         # Predict
         self.x = np.dot(self.F, self.x)  # + np_dot( self.B, u )
         self.P = np.dot(np.dot(self.F, self.P), self.F.transpose().copy()) + self.Q
+
+        # Everything the robot sees turns the other way when it turns, and moves
+        # the other way when it moves
+        rotation = 0
+        if heading is not None and self._last_heading is not None:
+            rotation = (heading - self._last_heading + 180) % 360 - 180
+        self._last_heading = heading
+        if rotation:
+            sin = math.sin(math.radians(rotation))
+            cos = math.cos(math.radians(rotation))
+            # Rotates (dx, dy) and (vx, vy) by -rotation in bearing terms
+            T = np.eye(self.n)
+            T[0:2, 0:2] = T[2:4, 2:4] = [[cos, -sin], [sin, cos]]
+            self.x = np.dot(T, self.x)
+            self.P = np.dot(np.dot(T, self.P), T.transpose())
+        self.x[0][0] -= velocity[0] * dt
+        self.x[1][0] -= velocity[1] * dt
         return self.x
 
     def update(self, z) -> None:
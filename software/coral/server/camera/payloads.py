@@ -0,0 +1,789 @@
+# Generated by microcontrollers/tools/generate_payloads.py from
+# microcontrollers/tools/payloads.py, do not edit!
+import struct
+from dataclasses import dataclass, field
+
+FRAME_VERSION = 9
+
+# NULL values
+NO_LINE_INT16 = 0x7fff
+NO_LINE_UINT8 = 0xff
+NO_CROSSING = 0xffff
+NO_ANGLE = 0x7fff
+NO_BOUNDS = 0xffff
+NO_BALL_INT16 = 0x7fff
+NO_BALL_UINT16 = 0xffff
+MUX_COMMAND_NONE = 0x0
+MUX_COMMAND_CALIBRATE = 0x1
+MUX_COMMAND_WRITE_PARAMETERS = 0x2
+MUX_COMMAND_SAVE_PARAMETERS = 0x3
+MUX_PARAMETER_CHUNK_SIZE = 0x10
+LDR_FILTER_K_OF_N = 0x0
+LDR_FILTER_HYSTERESIS = 0x1
+MUX_LDR_COUNT = 0x1e
+LDR_INTENSITY_BLOCK_SIZE = 0x8
+LDR_INTENSITY_MAX = 0xe
+NO_LDR_INTENSITY = 0xf
+LINK_TEST_PING = 0x1
+LINK_TEST_SWITCH = 0x2
+LINK_TEST_PATTERN = 0x3
+LINK_TEST_COMMIT = 0x4
+LINK_TEST_END = 0x5
+LINK_TEST_PATTERN_SIZE = 0x20
+
+# Payload type IDs
+PAYLOAD_MUX_TX = 1
+PAYLOAD_MUX_RX = 2
+PAYLOAD_IMU_TX = 3
+PAYLOAD_IMU_RX = 4
+PAYLOAD_TOF_TX = 5
+PAYLOAD_TOF_RX = 6
+PAYLOAD_CORAL_TX = 7
+PAYLOAD_CORAL_RX = 8
+PAYLOAD_LINK_TEST = 9
+PAYLOAD_MUX_LDR_TX = 10
+
+
+@dataclass
+class PacketHeader:
+    """Every payload sent to the Teensy starts with this header, so that it can tell new
+    packets from repeated or reordered ones and how old their data is."""
+
+    time: int = 0  # sender's micros() when the data was read
+    sequence: int = 0  # incremented for every packet, rolls over
+
+    FORMAT = "<IH"
+    SIZE = 6
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "PacketHeader":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.time,
+            self.sequence,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "PacketHeader":
+        time_ = next(values)
+        sequence_ = next(values)
+        return cls(
+            time=time_,
+            sequence=sequence_,
+        )
+
+
+@dataclass
+class LineData:
+    new_data: bool = True
+    angle_bisector: int = NO_LINE_INT16  # -179(.)99° to 180(.)00°
+    size: int = NO_LINE_UINT8  # 0(.)00 to 1(.)00
+    confidence: int = 0  # 0(.)00 to 1(.)00
+    size_rate: int = 0  # -327(.)68/s to 327(.)67/s
+    angle_rate: int = 0  # -3276(.)8°/s to 3276(.)7°/s
+    time_to_cross: int = NO_CROSSING  # in ms, until size is 1
+
+    FORMAT = "<BhBBhhH"
+    SIZE = 11
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "LineData":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.new_data << 0,
+            self.angle_bisector,
+            self.size,
+            self.confidence,
+            self.size_rate,
+            self.angle_rate,
+            self.time_to_cross,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "LineData":
+        flags0 = next(values)
+        angle_bisector_ = next(values)
+        size_ = next(values)
+        confidence_ = next(values)
+        size_rate_ = next(values)
+        angle_rate_ = next(values)
+        time_to_cross_ = next(values)
+        return cls(
+            new_data=bool(flags0 >> 0 & 1),
+            angle_bisector=angle_bisector_,
+            size=size_,
+            confidence=confidence_,
+            size_rate=size_rate_,
+            angle_rate=angle_rate_,
+            time_to_cross=time_to_cross_,
+        )
+
+
+@dataclass
+class LDRData:
+    """Which LDRs are on the line, and how strongly a block of them sees it (the blocks
+    take turns, so each intensity is only sent every few packets)."""
+
+    activations: int = 0  # bit i is set if LDR i is on the line
+    intensity_block: int = 0  # of LDR_INTENSITY_BLOCK_SIZE LDRs
+    intensities: list = field(default_factory=lambda: [0] * 4)  # two per byte, low nibble first
+
+    FORMAT = "<IB4B"
+    SIZE = 9
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "LDRData":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.activations,
+            self.intensity_block,
+            *self.intensities,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "LDRData":
+        activations_ = next(values)
+        intensity_block_ = next(values)
+        intensities_ = [next(values) for _ in range(4)]
+        return cls(
+            activations=activations_,
+            intensity_block=intensity_block_,
+            intensities=intensities_,
+        )
+
+
+@dataclass
+class IMUData:
+    new_data: bool = True
+    robot_angle: int = NO_ANGLE  # -179(.)99º to +180(.)00º
+
+    FORMAT = "<Bh"
+    SIZE = 3
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "IMUData":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.new_data << 0,
+            self.robot_angle,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "IMUData":
+        flags0 = next(values)
+        robot_angle_ = next(values)
+        return cls(
+            new_data=bool(flags0 >> 0 & 1),
+            robot_angle=robot_angle_,
+        )
+
+
+@dataclass
+class BoundsData:
+    front_new_data: bool = True
+    back_new_data: bool = True
+    left_new_data: bool = True
+    right_new_data: bool = True
+    front: int = NO_BOUNDS  # 0(.)0 cm to 400(.)0 cm
+    back: int = NO_BOUNDS  # 0(.)0 cm to 400(.)0 cm
+    left: int = NO_BOUNDS  # 0(.)0 cm to 400(.)0 cm
+    right: int = NO_BOUNDS  # 0(.)0 cm to 400(.)0 cm
+
+    FORMAT = "<BHHHH"
+    SIZE = 9
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "BoundsData":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.front_new_data << 0 | self.back_new_data << 1 | self.left_new_data << 2 | self.right_new_data << 3,
+            self.front,
+            self.back,
+            self.left,
+            self.right,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "BoundsData":
+        flags0 = next(values)
+        front_ = next(values)
+        back_ = next(values)
+        left_ = next(values)
+        right_ = next(values)
+        return cls(
+            front_new_data=bool(flags0 >> 0 & 1),
+            back_new_data=bool(flags0 >> 1 & 1),
+            left_new_data=bool(flags0 >> 2 & 1),
+            right_new_data=bool(flags0 >> 3 & 1),
+            front=front_,
+            back=back_,
+            left=left_,
+            right=right_,
+        )
+
+
+@dataclass
+class CameraData:
+    new_data: bool = True
+    ball_angle: int = NO_BALL_INT16  # -179(.)99° to 180(.)00°
+    ball_distance: int = NO_BALL_UINT16  # 0(.)0 cm to ~400(.)0 cm
+    blue_goal_angle: int = NO_BALL_INT16  # -179(.)99° to 180(.)00°
+    blue_goal_distance: int = NO_BALL_UINT16  # 0(.)0 cm to ~400(.)0 cm
+    yellow_goal_angle: int = NO_BALL_INT16  # -179(.)99° to 180(.)00°
+    yellow_goal_distance: int = NO_BALL_UINT16  # 0(.)0 cm to ~400(.)0 cm
+
+    FORMAT = "<BhHhHhH"
+    SIZE = 13
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "CameraData":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.new_data << 0,
+            self.ball_angle,
+            self.ball_distance,
+            self.blue_goal_angle,
+            self.blue_goal_distance,
+            self.yellow_goal_angle,
+            self.yellow_goal_distance,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "CameraData":
+        flags0 = next(values)
+        ball_angle_ = next(values)
+        ball_distance_ = next(values)
+        blue_goal_angle_ = next(values)
+        blue_goal_distance_ = next(values)
+        yellow_goal_angle_ = next(values)
+        yellow_goal_distance_ = next(values)
+        return cls(
+            new_data=bool(flags0 >> 0 & 1),
+            ball_angle=ball_angle_,
+            ball_distance=ball_distance_,
+            blue_goal_angle=blue_goal_angle_,
+            blue_goal_distance=blue_goal_distance_,
+            yellow_goal_angle=yellow_goal_angle_,
+            yellow_goal_distance=yellow_goal_distance_,
+        )
+
+
+@dataclass
+class BluetoothPayload:
+    """This should be symmetric."""
+
+    new_data: bool = True
+    master_is_striker: bool = True
+    ball_angle: float = float("nan")  # relative to field center
+    ball_distance: float = float("nan")
+    robot_angle: float = float("nan")  # relative to field center
+    robot_distance: float = float("nan")
+
+    FORMAT = "<Bffff"
+    SIZE = 17
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "BluetoothPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.new_data << 0 | self.master_is_striker << 1,
+            self.ball_angle,
+            self.ball_distance,
+            self.robot_angle,
+            self.robot_distance,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "BluetoothPayload":
+        flags0 = next(values)
+        ball_angle_ = next(values)
+        ball_distance_ = next(values)
+        robot_angle_ = next(values)
+        robot_distance_ = next(values)
+        return cls(
+            new_data=bool(flags0 >> 0 & 1),
+            master_is_striker=bool(flags0 >> 1 & 1),
+            ball_angle=ball_angle_,
+            ball_distance=ball_distance_,
+            robot_angle=robot_angle_,
+            robot_distance=robot_distance_,
+        )
+
+
+@dataclass
+class MUXParameters:
+    """Parameters of the STM32 MUX that can be changed without reflashing it."""
+
+    ldr_thresholds: list = field(default_factory=lambda: [0] * 30)  # one for each LDR
+    activation_threshold: int = 0  # in scans, see ldr_filter.h
+    calibration_multiplier: float = 0.0  # 0 (green) to 1 (white)
+    ldr_field_values: list = field(default_factory=lambda: [0] * 30)  # green, one for each LDR
+    ldr_line_values: list = field(default_factory=lambda: [0] * 30)  # white, one for each LDR
+    analog_line_estimation: int = 0  # 0 or 1, see findLine()
+    adaptive_thresholds: int = 0  # 0 or 1, see adaptLDRLevels()
+    ldr_filter: int = LDR_FILTER_K_OF_N  # see ldr_filter.h
+    ldr_filter_window: int = 0  # in scans
+    deactivation_threshold: int = 0  # in scans, for hysteresis
+
+    FORMAT = "<30HHf30H30HBBBBB"
+    SIZE = 191
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "MUXParameters":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            *self.ldr_thresholds,
+            self.activation_threshold,
+            self.calibration_multiplier,
+            *self.ldr_field_values,
+            *self.ldr_line_values,
+            self.analog_line_estimation,
+            self.adaptive_thresholds,
+            self.ldr_filter,
+            self.ldr_filter_window,
+            self.deactivation_threshold,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "MUXParameters":
+        ldr_thresholds_ = [next(values) for _ in range(30)]
+        activation_threshold_ = next(values)
+        calibration_multiplier_ = next(values)
+        ldr_field_values_ = [next(values) for _ in range(30)]
+        ldr_line_values_ = [next(values) for _ in range(30)]
+        analog_line_estimation_ = next(values)
+        adaptive_thresholds_ = next(values)
+        ldr_filter_ = next(values)
+        ldr_filter_window_ = next(values)
+        deactivation_threshold_ = next(values)
+        return cls(
+            ldr_thresholds=ldr_thresholds_,
+            activation_threshold=activation_threshold_,
+            calibration_multiplier=calibration_multiplier_,
+            ldr_field_values=ldr_field_values_,
+            ldr_line_values=ldr_line_values_,
+            analog_line_estimation=analog_line_estimation_,
+            adaptive_thresholds=adaptive_thresholds_,
+            ldr_filter=ldr_filter_,
+            ldr_filter_window=ldr_filter_window_,
+            deactivation_threshold=deactivation_threshold_,
+        )
+
+
+@dataclass
+class MUXTXPayload:
+    header: PacketHeader = field(default_factory=PacketHeader)
+    line: LineData = field(default_factory=LineData)
+    command_id: int = 0  # of the last command carried out, 0 if none
+    command_failed: bool = False
+    threshold_drift: int = 0  # in ADC counts, see adaptLDRLevels()
+    threshold_drift_ldr: int = 0  # whose threshold drifted most
+
+    FORMAT = "<IHBhBBhhHBBhB"
+    SIZE = 22
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "MUXTXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            *self.header.values(),
+            *self.line.values(),
+            self.command_id,
+            self.command_failed << 0,
+            self.threshold_drift,
+            self.threshold_drift_ldr,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "MUXTXPayload":
+        header_ = PacketHeader.from_values(values)
+        line_ = LineData.from_values(values)
+        command_id_ = next(values)
+        flags3 = next(values)
+        threshold_drift_ = next(values)
+        threshold_drift_ldr_ = next(values)
+        return cls(
+            header=header_,
+            line=line_,
+            command_id=command_id_,
+            command_failed=bool(flags3 >> 0 & 1),
+            threshold_drift=threshold_drift_,
+            threshold_drift_ldr=threshold_drift_ldr_,
+        )
+
+
+@dataclass
+class MUXLDRTXPayload:
+    """Sent by the STM32 MUX instead of MUXTXPayload with MUX_LDR_DATA (see
+    shared_config.h)."""
+
+    header: PacketHeader = field(default_factory=PacketHeader)
+    line: LineData = field(default_factory=LineData)
+    command_id: int = 0  # of the last command carried out, 0 if none
+    command_failed: bool = False
+    threshold_drift: int = 0  # in ADC counts, see adaptLDRLevels()
+    threshold_drift_ldr: int = 0  # whose threshold drifted most
+    ldrs: LDRData = field(default_factory=LDRData)
+
+    FORMAT = "<IHBhBBhhHBBhBIB4B"
+    SIZE = 31
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "MUXLDRTXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            *self.header.values(),
+            *self.line.values(),
+            self.command_id,
+            self.command_failed << 0,
+            self.threshold_drift,
+            self.threshold_drift_ldr,
+            *self.ldrs.values(),
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "MUXLDRTXPayload":
+        header_ = PacketHeader.from_values(values)
+        line_ = LineData.from_values(values)
+        command_id_ = next(values)
+        flags3 = next(values)
+        threshold_drift_ = next(values)
+        threshold_drift_ldr_ = next(values)
+        ldrs_ = LDRData.from_values(values)
+        return cls(
+            header=header_,
+            line=line_,
+            command_id=command_id_,
+            command_failed=bool(flags3 >> 0 & 1),
+            threshold_drift=threshold_drift_,
+            threshold_drift_ldr=threshold_drift_ldr_,
+            ldrs=ldrs_,
+        )
+
+
+@dataclass
+class MUXRXPayload:
+    """A command for the STM32 MUX, which carries it out once for each commandId and
+    acknowledges it in MUXTXPayload. Parameters are uploaded as chunks of MUXParameters,
+    then saved.."""
+
+    command: int = MUX_COMMAND_NONE
+    command_id: int = 0  # 1 to 255, as 0 means none
+    offset: int = 0  # of data in MUXParameters, in bytes
+    data: list = field(default_factory=lambda: [0] * MUX_PARAMETER_CHUNK_SIZE)
+
+    FORMAT = "<BBB16B"
+    SIZE = 19
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "MUXRXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.command,
+            self.command_id,
+            self.offset,
+            *self.data,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "MUXRXPayload":
+        command_ = next(values)
+        command_id_ = next(values)
+        offset_ = next(values)
+        data_ = [next(values) for _ in range(MUX_PARAMETER_CHUNK_SIZE)]
+        return cls(
+            command=command_,
+            command_id=command_id_,
+            offset=offset_,
+            data=data_,
+        )
+
+
+@dataclass
+class IMUTXPayload:
+    header: PacketHeader = field(default_factory=PacketHeader)
+    imu: IMUData = field(default_factory=IMUData)
+
+    FORMAT = "<IHBh"
+    SIZE = 9
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "IMUTXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            *self.header.values(),
+            *self.imu.values(),
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "IMUTXPayload":
+        header_ = PacketHeader.from_values(values)
+        imu_ = IMUData.from_values(values)
+        return cls(
+            header=header_,
+            imu=imu_,
+        )
+
+
+@dataclass
+class IMURXPayload:
+    calibrating: bool = False
+
+    FORMAT = "<B"
+    SIZE = 1
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "IMURXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.calibrating << 0,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "IMURXPayload":
+        flags0 = next(values)
+        return cls(
+            calibrating=bool(flags0 >> 0 & 1),
+        )
+
+
+@dataclass
+class TOFTXPayload:
+    header: PacketHeader = field(default_factory=PacketHeader)
+    bounds: BoundsData = field(default_factory=BoundsData)
+    bluetooth_inbound_payload: BluetoothPayload = field(default_factory=BluetoothPayload)
+
+    FORMAT = "<IHBHHHHBffff"
+    SIZE = 32
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "TOFTXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            *self.header.values(),
+            *self.bounds.values(),
+            *self.bluetooth_inbound_payload.values(),
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "TOFTXPayload":
+        header_ = PacketHeader.from_values(values)
+        bounds_ = BoundsData.from_values(values)
+        bluetooth_inbound_payload_ = BluetoothPayload.from_values(values)
+        return cls(
+            header=header_,
+            bounds=bounds_,
+            bluetooth_inbound_payload=bluetooth_inbound_payload_,
+        )
+
+
+@dataclass
+class TOFRXPayload:
+    bluetooth_outbound_payload: BluetoothPayload = field(default_factory=BluetoothPayload)
+
+    FORMAT = "<Bffff"
+    SIZE = 17
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "TOFRXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            *self.bluetooth_outbound_payload.values(),
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "TOFRXPayload":
+        bluetooth_outbound_payload_ = BluetoothPayload.from_values(values)
+        return cls(
+            bluetooth_outbound_payload=bluetooth_outbound_payload_,
+        )
+
+
+@dataclass
+class CoralTXPayload:
+    header: PacketHeader = field(default_factory=PacketHeader)
+    camera: CameraData = field(default_factory=CameraData)
+
+    FORMAT = "<IHBhHhHhH"
+    SIZE = 19
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "CoralTXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            *self.header.values(),
+            *self.camera.values(),
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "CoralTXPayload":
+        header_ = PacketHeader.from_values(values)
+        camera_ = CameraData.from_values(values)
+        return cls(
+            header=header_,
+            camera=camera_,
+        )
+
+
+@dataclass
+class CoralRXPayload:
+    """Sent to the Coral at a fixed rate so that it can compensate its tracking for the
+    robot's own motion."""
+
+    heading: int = NO_ANGLE  # -179(.)99° to 180(.)00°
+    heading_rate: int = 0  # -3276(.)8°/s to 3276(.)7°/s
+    movement_angle: int = 0  # -179(.)99° to 180(.)00°, relative
+    movement_velocity: int = 0  # ±35 to ±1023, 0 to stop
+
+    FORMAT = "<hhhh"
+    SIZE = 8
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "CoralRXPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.heading,
+            self.heading_rate,
+            self.movement_angle,
+            self.movement_velocity,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "CoralRXPayload":
+        heading_ = next(values)
+        heading_rate_ = next(values)
+        movement_angle_ = next(values)
+        movement_velocity_ = next(values)
+        return cls(
+            heading=heading_,
+            heading_rate=heading_rate_,
+            movement_angle=movement_angle_,
+            movement_velocity=movement_velocity_,
+        )
+
+
+@dataclass
+class LinkTestPayload:
+    """Sent by the Teensy to negotiate the baud rate of a link, and echoed back by the
+    STM32 (see link_test.h)."""
+
+    command: int = LINK_TEST_PING
+    sequence: int = 0
+    baud_rate: int = 0  # to switch to
+    pattern: list = field(default_factory=lambda: [0] * LINK_TEST_PATTERN_SIZE)
+
+    FORMAT = "<BHI32B"
+    SIZE = 39
+
+    def pack(self) -> bytes:
+        return struct.pack(self.FORMAT, *self.values())
+
+    @classmethod
+    def unpack(cls, buf: bytes) -> "LinkTestPayload":
+        return cls.from_values(iter(struct.unpack(cls.FORMAT, buf)))
+
+    def values(self) -> list:
+        return [
+            self.command,
+            self.sequence,
+            self.baud_rate,
+            *self.pattern,
+        ]
+
+    @classmethod
+    def from_values(cls, values) -> "LinkTestPayload":
+        command_ = next(values)
+        sequence_ = next(values)
+        baud_rate_ = next(values)
+        pattern_ = [next(values) for _ in range(LINK_TEST_PATTERN_SIZE)]
+        return cls(
+            command=command_,
+            sequence=sequence_,
+            baud_rate=baud_rate_,
+            pattern=pattern_,
+        )
@@ -1,20 +1,39 @@
+import binascii
 import struct
-from typing import Tuple
+import time
+from typing import Optional, Tuple
 
-import numpy as np
 from cobs import cobs
 from serial import Serial
 
+from .payloads import (
+    FRAME_VERSION,
+    NO_BALL_INT16,
+    NO_BALL_UINT16,
+    PAYLOAD_CORAL_RX,
+    PAYLOAD_CORAL_TX,
+    CameraData,
+    CoralRXPayload,
+    CoralTXPayload,
+    PacketHeader,
+)
+
 
 TEENSY_SERIAL_DEVICE = "/dev/ttyS0"
 TEENSY_SERIAL_BAUD_RATE = 1000000
 TEENSY_SERIAL_TX_START_BYTE = 0b11010110
 TEENSY_SERIAL_TX_END_BYTE = 0b00110010
+TEENSY_SERIAL_READ_TIMEOUT = 0.1  # in s, so that reading threads can stop
 
 
 class TeensySerial:
     def __init__(self) -> None:
-        self._serial = Serial(TEENSY_SERIAL_DEVICE, TEENSY_SERIAL_BAUD_RATE)
+        self._serial = Serial(
+            TEENSY_SERIAL_DEVICE,
+            TEENSY_SERIAL_BAUD_RATE,
+            timeout=TEENSY_SERIAL_READ_TIMEOUT,
+        )
+        self._sequence = 0
 
     def close(self) -> None:
         self._serial.flushInput()
@@ -27,50 +46,53 @@ class TeensySerial:
         blue_goal: Tuple[float, float],
         yellow_goal: Tuple[float, float],
     ) -> None:
+        # Prepare header
+        timestamp = time.monotonic_ns() // 1000 & 0xFFFFFFFF  # µs, rolls over
+        self._sequence = (self._sequence + 1) & 0xFFFF
+
         # Prepare data
-        new_data = True
-        ball_angle = (
-            round(ball[0] * 100)  # -179(.)99º to 180(.)00º
-            if ball[0]
-            else np.iinfo(np.int16).max  # Flag for no ball
-        )
-        ball_distance = (
-            round(ball[1] * 100)  # from 0(.)00 cm
-            if ball[1]
-            else np.iinfo(np.uint16).max  # Flag for no ball
-        )
-        blue_goal_angle = (
-            round(blue_goal[0] * 100)  # -179(.)99º to 180(.)00º
-            if blue_goal[0]
-            else np.iinfo(np.int16).max  # Flag for no goal
-        )
-        blue_goal_distance = (
-            round(blue_goal[1] * 100)  # from 0(.)00 cm
-            if blue_goal[1]
-            else np.iinfo(np.uint16).max  # Flag for no goal
-        )
-        yellow_goal_angle = (
-            round(yellow_goal[0] * 100)  # -179(.)99º to 180(.)00º
-            if yellow_goal[0]
-            else np.iinfo(np.int16).max  # Flag for no ball
-        )
-        yellow_goal_distance = (
-            round(yellow_goal[1] * 100)  # from 0(.)00 cm
-            if yellow_goal[1]
-            else np.iinfo(np.uint16).max  # Flag for no ball
+        camera = CameraData(
+            ball_angle=(
+                round(ball[0] * 100)  # -179(.)99º to 180(.)00º
+                if ball[0]
+                else NO_BALL_INT16  # Flag for no ball
+            ),
+            ball_distance=(
+                round(ball[1] * 100)  # from 0(.)00 cm
+                if ball[1]
+                else NO_BALL_UINT16  # Flag for no ball
+            ),
+            blue_goal_angle=(
+                round(blue_goal[0] * 100)  # -179(.)99º to 180(.)00º
+                if blue_goal[0]
+                else NO_BALL_INT16  # Flag for no goal
+            ),
+            blue_goal_distance=(
+                round(blue_goal[1] * 100)  # from 0(.)00 cm
+                if blue_goal[1]
+                else NO_BALL_UINT16  # Flag for no goal
+            ),
+            yellow_goal_angle=(
+                round(yellow_goal[0] * 100)  # -179(.)99º to 180(.)00º
+                if yellow_goal[0]
+                else NO_BALL_INT16  # Flag for no goal
+            ),
+            yellow_goal_distance=(
+                round(yellow_goal[1] * 100)  # from 0(.)00 cm
+                if yellow_goal[1]
+                else NO_BALL_UINT16  # Flag for no goal
+            ),
         )
 
-        # Pack data
-        buf = struct.pack(
-            "<HhHhHhH",
-            new_data,  # H, unsigned short (bool is padded to 2 bytes in struct on Teensy)
-            ball_angle,  # h, short
-            ball_distance,  # H, unsigned short
-            blue_goal_angle,  # h, short
-            blue_goal_distance,  # H, unsigned short
-            yellow_goal_angle,  # h, short
-            yellow_goal_distance,  # H, unsigned short
-        )
+        # Pack data (see microcontrollers/tools/payloads.py for the layout)
+        buf = CoralTXPayload(
+            header=PacketHeader(time=timestamp, sequence=self._sequence),
+            camera=camera,
+        ).pack()
+
+        # Frame with the protocol version, payload type and CRC-16/CCITT-FALSE
+        buf = bytes([FRAME_VERSION, PAYLOAD_CORAL_TX]) + buf
+        buf += struct.pack("<H", binascii.crc_hqx(buf, 0xFFFF))
 
         # Encode with COBS
         buf = cobs.encode(buf)
@@ -78,3 +100,30 @@ class TeensySerial:
 
         # Send packet
         self._serial.write(buf)
+
+    def read_packet(self) -> Optional[CoralRXPayload]:
+        """
+        Wait for the next packet from the Teensy, returning None if it timed out or
+        was corrupted.
+        """
+
+        buf = self._serial.read_until(b"\x00")
+        if not buf.endswith(b"\x00"):
+            return None  # timed out
+
+        # Decode with COBS
+        try:
+            buf = cobs.decode(buf[:-1])
+        except cobs.DecodeError:
+            return None
+
+        # Check the protocol version, payload type and CRC-16/CCITT-FALSE
+        if len(buf) != 2 + CoralRXPayload.SIZE + 2:
+            return None
+        if struct.unpack("<H", buf[-2:])[0] != binascii.crc_hqx(buf[:-2], 0xFFFF):
+            return None
+        if buf[0] != FRAME_VERSION or buf[1] != PAYLOAD_CORAL_RX:
+            return None
+
+        # Unpack data (see microcontrollers/tools/payloads.py for the layout)
+        return CoralRXPayload.unpack(buf[2:-2])
@@ -1,11 +1,20 @@
 #ifndef ANGLE_H
 #define ANGLE_H
 
+#include <cmath>
 #include <cstdint>
 
 #define SIN45 0.70710678F
 #define COS45 0.70710678F
 
+#define DEG_TO_RADF 0.017453292519943295F
+#define RAD_TO_DEGF 57.295779513082321F
+
+// Maximum absolute errors of the approximations in angle.cpp
+#define SINCOSFD_MAX_ERROR  1.2e-7F // sincosfd(), sinfd() and cosfd()
+#define ATAN2FD_MAX_ERROR   1.2e-4F // atan2fd(), in degrees
+#define CLIPANGLE_MAX_ERROR 1.0e-4F // clipAngle() for |x| ≤ 720º, in degrees
+
 float clipBearing(float dividend);
 float bearingDiff(float leftAngle, float rightAngle);
 float smallerBearingDiff(float leftAngle, float rightAngle);
@@ -14,8 +23,108 @@ float bearingMidpoint(float leftAngle, float rightAngle);
 float bearingToAngle(float bearing);
 float clipAngle(float dividend);
 
+void sincosfd(float x, float &sine, float &cosine);
 float sinfd(float x);
 float cosfd(float x);
 float atan2fd(float x, float y);
 
+// Biased exponents of floats: ones with FLOAT_EXPONENT_WHOLE or more have no
+// fraction, and FLOAT_EXPONENT_NONFINITE means infinite or NaN
+#define FLOAT_EXPONENT_WHOLE     150 // 2^23
+#define FLOAT_EXPONENT_NONFINITE 255
+
+// Returns the biased exponent of a float. Its bits are read, as -Ofast assumes
+// that floats are finite and would optimise std::isfinite() away (with
+// __builtin_bit_cast(), from GCC 11, rather than memcpy() to stay constexpr).
+constexpr uint8_t floatExponent(float x) {
+    return __builtin_bit_cast(uint32_t, x) >> 23 & 0xFF;
+}
+
+// An angle in binary angle measurement (BAM), where the whole uint16_t range is
+// one turn (1 unit = 0.0055º). Arithmetic wraps around by itself, so angles
+// never need clipping and differences are exact. It is finer than the
+// centidegrees sent over serial, so those convert to and fro losslessly.
+class BinaryAngle {
+  public:
+    constexpr BinaryAngle() : _raw(0) {}
+
+    static constexpr BinaryAngle fromRaw(uint16_t raw) {
+        return BinaryAngle(raw);
+    }
+    // Any centidegree value works, e.g. -179(.)99º to 180(.)00º from a packet
+    static constexpr BinaryAngle fromCentidegrees(int16_t centidegrees) {
+        const int32_t scaled = (int32_t)centidegrees * 32768;
+        return BinaryAngle((scaled + (scaled < 0 ? -9000 : 9000)) / 18000);
+    }
+    // Non-finite degrees, which have no angle, give 0º
+    static constexpr BinaryAngle fromDegrees(float degrees) {
+        // Reduce exactly to ±180º first, so that every turn of an angle gives
+        // the same result and the conversion to int32_t can't overflow (huge
+        // degrees with fmodf(), as they have no fraction of a turn in turns)
+        const auto exponent = floatExponent(degrees);
+        if (exponent == FLOAT_EXPONENT_NONFINITE) return BinaryAngle();
+        if (exponent >= FLOAT_EXPONENT_WHOLE) degrees = fmodf(degrees, 360.0F);
+        degrees -= 360.0F * roundf(degrees * (1.0F / 360.0F));
+        const auto scaled = degrees * (65536.0F / 360.0F);
+        return BinaryAngle((int32_t)(scaled + (scaled < 0 ? -0.5F : 0.5F)));
+    }
+
+    constexpr uint16_t raw() const { return _raw; }
+    // -179(.)99º to 180(.)00º
+    constexpr int16_t centidegrees() const {
+        if (_raw == 0x8000) return 18000;
+        const int32_t scaled = (int32_t)(int16_t)_raw * 18000;
+        return (scaled + (scaled < 0 ? -16384 : 16384)) / 32768;
+    }
+    // -179.99º to +180.00º
+    constexpr float degrees() const {
+        if (_raw == 0x8000) return 180.0F;
+        return (int16_t)_raw * (180.0F / 32768.0F);
+    }
+    // 0.00º to 359.99º
+    constexpr float bearing() const { return _raw * (360.0F / 65536.0F); }
+
+    // Size of the angle, from 0º to 180º (i.e. the smaller bearing difference
+    // when applied to the difference of two angles)
+    constexpr BinaryAngle abs() const {
+        return BinaryAngle((int16_t)_raw < 0 ? -_raw : _raw);
+    }
+
+    constexpr BinaryAngle operator+(const BinaryAngle &other) const {
+        return BinaryAngle(_raw + other._raw);
+    }
+    constexpr BinaryAngle operator-() const { return BinaryAngle(-_raw); }
+    constexpr BinaryAngle operator-(const BinaryAngle &other) const {
+        return BinaryAngle(_raw - other._raw);
+    }
+    BinaryAngle &operator+=(const BinaryAngle &other) {
+        _raw += other._raw;
+        return *this;
+    }
+    BinaryAngle &operator-=(const BinaryAngle &other) {
+        _raw -= other._raw;
+        return *this;
+    }
+
+    // Comparisons order angles by bearing
+    constexpr bool operator==(const BinaryAngle &other) const {
+        return _raw == other._raw;
+    }
+    constexpr bool operator!=(const BinaryAngle &other) const {
+        return _raw != other._raw;
+    }
+    constexpr bool operator<(const BinaryAngle &other) const {
+        return _raw < other._raw;
+    }
+    constexpr bool operator>(const BinaryAngle &other) const {
+        return _raw > other._raw;
+    }
+
+  private:
+    // Wraps any integer onto the circle
+    constexpr explicit BinaryAngle(int32_t raw) : _raw((uint16_t)raw) {}
+
+    uint16_t _raw;
+};
+
 #endif
@@ -0,0 +1,67 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+// Entries are kept in a ring buffer of this many bytes (a few seconds of
+// every link at full rate, in RAM2 on the Teensy)
+#ifndef FLIGHT_RECORDER_BUFFER_SIZE
+    #define FLIGHT_RECORDER_BUFFER_SIZE 393216
+#endif
+#define FLIGHT_RECORDER_MAX_DATA_SIZE 256
+
+// Where an entry came from
+// Keep in sync with tools/flight_recorder.py!
+enum FlightRecorderSource : uint8_t {
+    FLIGHT_RECORDER_MUX = 0,
+    FLIGHT_RECORDER_TOF = 1,
+    FLIGHT_RECORDER_IMU = 2,
+    FLIGHT_RECORDER_CORAL = 3,
+    FLIGHT_RECORDER_LIGHTGATE = 4, // uint8_t hasBall, as a change is read
+    FLIGHT_RECORDER_END = 0xFF,    // marks the end of a dump
+};
+// Each entry is this header followed by its data. When dumped, each entry is
+// COBS-encoded with a zero delimiter like the other serial links.
+struct __attribute__((packed)) FlightRecorderEntryHeader {
+    uint8_t source;
+    uint32_t time; // in µs
+    uint16_t size; // of the data
+};
+
+// A black box that keeps the most recent frames received on the serial links
+// (COBS-decoded, but otherwise as they arrived) and lightgate changes,
+// overwriting the oldest. After a run, the recording can be dumped over USB
+// with tools/flight_recorder.py and replayed on the host through the real
+// Sensors and strategy code (see src/native/replay.cpp).
+class FlightRecorder {
+  public:
+    // The buffer should be FLIGHT_RECORDER_BUFFER_SIZE bytes, ideally DMAMEM
+    FlightRecorder(uint8_t *buffer, const size_t size)
+        : _buffer(buffer), _size(size) {}
+
+    void record(const uint8_t source, const uint32_t time, const uint8_t *data,
+                const size_t size);
+    // Writes every entry, oldest first, then a FLIGHT_RECORDER_END entry.
+    // Nothing is recorded meanwhile.
+    void dump(Stream &serial = Serial);
+    void clear();
+
+    uint32_t entries() const { return _entries; }
+    size_t used() const { return (_head + _size - _tail) % _size; }
+
+  private:
+    void _write(const uint8_t *data, const size_t size);
+    void _read(size_t position, uint8_t *data, const size_t size) const;
+    void _dropOldest();
+
+    uint8_t *_buffer;
+    size_t _size;
+    size_t _head = 0; // next byte to write into
+    size_t _tail = 0; // start of the oldest entry
+    uint32_t _entries = 0;
+    bool _dumping = false;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FRAMING_H
+#define FRAMING_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "payloads.h"
+
+// Every packet on the serial links is a frame of
+//   [version] [payload type] [payload ...] [CRC-16, little endian]
+// which is then COBS-encoded by PacketSerial. The CRC (CRC-16/CCITT-FALSE)
+// covers everything before it.
+// FRAME_VERSION and the payload type IDs are in payloads.h.
+#define FRAME_OVERHEAD 4 // version, type and CRC
+
+uint16_t crc16(const uint8_t *buffer, size_t size, uint16_t crc = 0xFFFF);
+
+// Writes a payload into a frame of size + FRAME_OVERHEAD bytes, and returns
+// the size of the frame
+size_t encodeFrame(const uint8_t type, const uint8_t *payload,
+                   const size_t size, uint8_t *frame);
+// Checks a frame and points payload to the payload inside it. Returns false if
+// the frame is corrupted or of another version or payload type.
+bool decodeFrame(const uint8_t *frame, const size_t size, const uint8_t type,
+                 const uint8_t *&payload, size_t &payloadSize);
+
+// Frames a payload and sends it over a PacketSerial (or SerialLink).
+template <typename Link, typename Payload>
+void sendFrame(Link &link, const uint8_t type, const Payload &payload) {
+    uint8_t frame[sizeof(Payload) + FRAME_OVERHEAD];
+    const auto size =
+        encodeFrame(type, (const uint8_t *)&payload, sizeof(payload), frame);
+    link.send(frame, size);
+}
+
+// Scales a field of a received payload, or returns NAN if it is the NO_*
+// sentinel for no data (converted to the type of the field).
+template <typename T>
+inline float fromWire(const T value, const std::common_type_t<T> sentinel,
+                      const float scale) {
+    return value != sentinel ? value * scale : NAN;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef LDR_FILTER_H
+#define LDR_FILTER_H
+
+#include <array>
+#include <cstdint>
+
+#include "payloads.h"
+
+#define LDR_FILTER_MAX_WINDOW 15 // in scans
+#define LDR_FILTER_COUNT_BITS 4  // enough to count to LDR_FILTER_MAX_WINDOW
+
+// Debounces which of up to 32 LDRs are on the line, given which were above
+// their thresholds in each scan (bit i for LDR i). Every LDR is filtered at
+// once, bit-sliced: how many of the last window scans each was hit in is kept
+// as a 4-bit counter, bit b of which is bit i of _counts[b].
+//
+// Policies (MUXParameters::ldrFilter), and their latency in scans when the
+// LDR is hit or missed in every scan:
+//  - LDR_FILTER_K_OF_N: on while it was hit in at least k (onThreshold) of the
+//    last n (window) scans. Turns on k scans after it is first hit, and off
+//    n - k + 1 scans after it is first missed. k-of-k is the old debounce of
+//    k consecutive hits, which restarts whenever a single scan is missed.
+//  - LDR_FILTER_HYSTERESIS: turns on once hit in at least onThreshold of the
+//    last window scans, and only off once hit in offThreshold or fewer. Turns
+//    on onThreshold scans after it is first hit, and off window - offThreshold
+//    scans after it is first missed.
+class LDRFilter {
+  public:
+    // Returns false if a policy can't be used
+    static bool valid(const uint8_t policy, const uint8_t window,
+                      const uint8_t onThreshold, const uint8_t offThreshold);
+    // Starts filtering afresh with a (valid) policy
+    void configure(const uint8_t policy, const uint8_t window,
+                   const uint8_t onThreshold, const uint8_t offThreshold = 0);
+    void reset();
+
+    // Adds a scan, and returns which LDRs are on the line
+    uint32_t update(const uint32_t hits);
+    uint32_t state() const { return _state; }
+
+  private:
+    uint32_t _atLeast(const uint8_t count) const;
+
+    uint8_t _window = 1;
+    uint8_t _onThreshold = 1;
+    uint8_t _offThreshold = 0;
+
+    std::array<uint32_t, LDR_FILTER_MAX_WINDOW> _history = {}; // of hits
+    uint8_t _head = 0; // oldest scan in _history
+    std::array<uint32_t, LDR_FILTER_COUNT_BITS> _counts = {};
+    uint32_t _state = 0;
+};
+
+#endif
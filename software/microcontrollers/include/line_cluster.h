@@ -0,0 +1,14 @@
+#ifndef LINE_CLUSTER_H
+#define LINE_CLUSTER_H
+
+#include <cstdint>
+
+// Finds the two matches (indices into bearings, in º) that are furthest apart
+// around the circle, i.e. the ends of the cluster of LDRs on the line, in
+// O(matchCount). The matches must be in increasing order of bearing. Ties go
+// to the first pair in index order, and start is the lower index of the two.
+// Returns false if there are fewer than two matches.
+bool findLineCluster(const float *bearings, const uint8_t *matches,
+                     const uint8_t matchCount, uint8_t &start, uint8_t &end);
+
+#endif
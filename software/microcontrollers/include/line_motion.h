@@ -0,0 +1,72 @@
+#ifndef LINE_MOTION_H
+#define LINE_MOTION_H
+
+#include <array>
+#include <cstdint>
+
+#include "angle.h"
+#include "payloads.h"
+
+// Estimates how fast the line's size and bisector are changing from where its
+// ends are found in each scan, and how long the robot will take to be over the
+// middle of the line (where its size is 1) at that rate.
+//
+// The ends are found from LDRs ~12º apart, so each moves in steps of its own
+// rather than smoothly, and the span between them jumps whenever either one
+// steps. Each end's rate is therefore measured over its last LINE_MOTION_MOVES
+// moves of at least minStep from the time they took, rather than from scan to
+// scan (where a single step looks like a sudden rush), and the size and
+// bisector rates are worked out from the two. While an end doesn't move, its
+// rate is limited to what its last move over the time since then allows, so
+// it falls once the line stops.
+#define LINE_MOTION_MOVES 4
+
+class LineMotion {
+  public:
+    struct Config {
+        float minStep;         // in º, for an end to have moved
+        float gain;            // 0 to 1 (1 for no smoothing), for each move
+        float minApproachRate; // in size/s, to be crossing the line
+        float maxEndMove;      // in º, larger moves of an end between scans
+                               // are a different line, so it starts over
+    };
+
+    explicit LineMotion(const Config &config) : _config(config) {}
+
+    // Updates the estimates with the line found in a scan at time (in µs),
+    // between start and end (either way round), and fills in its sizeRate,
+    // angleRate and timeToCross.
+    void update(LineData &line, const BinaryAngle start, const BinaryAngle end,
+                const uint32_t time);
+    void reset();
+
+    float sizeRate() const;  // per s
+    float angleRate() const; // in º/s, clockwise
+
+  private:
+    // An end of the line, and its rate
+    struct Track {
+        // Where it moved to (unwrapped, in º) and when (in µs) in the last
+        // moves, oldest first, starting from where it was first seen
+        std::array<float, LINE_MOTION_MOVES + 1> positions;
+        std::array<uint32_t, LINE_MOTION_MOVES + 1> times;
+        uint8_t count = 0;     // of the positions kept
+        bool firstSeen = true; // the first position is where it was first seen
+                               // (at some point between steps), not a move
+        BinaryAngle value;     // at the last move
+        float step = 0;        // size of the last move, in º
+        bool rated = false;    // since first seen
+        float rate = 0;        // in º/s, clockwise
+    };
+
+    void _update(Track &track, const BinaryAngle value, const uint32_t time);
+
+    Config _config;
+    // Each follows the same end of the line from scan to scan, so they swap
+    // which is clockwise of the other as the robot crosses the middle of the
+    // line (and the bisector flips)
+    std::array<Track, 2> _ends;
+    uint8_t _clockwise = 1; // index of the end clockwise of the other
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef LINK_TEST_H
+#define LINK_TEST_H
+
+#include <Arduino.h>
+#include <PacketSerial.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "shared_config.h"
+
+// Link tests let the Teensy and an STM32 agree on the fastest baud rate in
+// LINK_BAUD_RATES at which frames get through reliably. The Teensy leads: it
+// finds the rate the STM32 is at, then for each faster rate asks the STM32 to
+// switch, switches too, has LINK_TEST_FRAMES patterns echoed back and commits
+// to the rate if few enough of them were lost. If anything goes wrong, both
+// sides fall back to the last committed rate.
+
+struct LinkTestResult {
+    bool tested = false;
+    bool passed = false;
+    uint16_t errors = 0; // frames lost or corrupted, of LINK_TEST_FRAMES
+};
+typedef std::array<LinkTestResult, LINK_BAUD_RATES.size()> LinkTestResults;
+
+// On the Teensy: negotiates the baud rate of a link before it is used (or
+// again, once it seems lost) and returns the rate agreed on, or 0 if the STM32
+// wasn't found within connectTimeout (in ms, after looking at every rate once)
+// and the link was left at the rate everything starts at. Stops at the first
+// rate that fails unless testAll is set.
+uint32_t negotiateBaudRate(HardwareSerial &serial, LinkTestResults &results,
+                           const bool testAll = false,
+                           const uint32_t connectTimeout =
+                               LINK_TEST_CONNECT_TIMEOUT);
+void printLinkTestResults(const char *name, const LinkTestResults &results,
+                          Stream &serial = Serial);
+
+// On the STM32s: answers link tests. Call with every frame received, returns
+// true if it was part of a link test, which is over by the time it returns.
+bool respondToLinkTest(const uint8_t *frame, const size_t size,
+                       HardwareSerial &serial, PacketSerial &packetSerial);
+
+#endif
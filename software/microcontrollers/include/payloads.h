@@ -0,0 +1,354 @@
+// Generated by tools/generate_payloads.py from tools/payloads.py, do not edit!
+#ifndef PAYLOADS_H
+#define PAYLOADS_H
+
+#include <cmath>
+#include <cstdint>
+
+#include "angle.h"
+#include "vector.h"
+
+#define FRAME_VERSION 9
+
+// NULL values
+#define NO_LINE_INT16                INT16_MAX
+#define NO_LINE_UINT8                UINT8_MAX
+#define NO_CROSSING                  UINT16_MAX
+#define NO_ANGLE                     INT16_MAX
+#define NO_BOUNDS                    UINT16_MAX
+#define NO_BALL_INT16                INT16_MAX
+#define NO_BALL_UINT16               UINT16_MAX
+#define MUX_COMMAND_NONE             0
+#define MUX_COMMAND_CALIBRATE        1
+#define MUX_COMMAND_WRITE_PARAMETERS 2
+#define MUX_COMMAND_SAVE_PARAMETERS  3
+#define MUX_PARAMETER_CHUNK_SIZE     16
+#define LDR_FILTER_K_OF_N            0
+#define LDR_FILTER_HYSTERESIS        1
+#define MUX_LDR_COUNT                30
+#define LDR_INTENSITY_BLOCK_SIZE     8
+#define LDR_INTENSITY_MAX            14
+#define NO_LDR_INTENSITY             15
+#define LINK_TEST_PING               1
+#define LINK_TEST_SWITCH             2
+#define LINK_TEST_PATTERN            3
+#define LINK_TEST_COMMIT             4
+#define LINK_TEST_END                5
+#define LINK_TEST_PATTERN_SIZE       32
+
+// Payload type IDs
+enum PayloadType : uint8_t {
+    PAYLOAD_MUX_TX = 1,
+    PAYLOAD_MUX_RX = 2,
+    PAYLOAD_IMU_TX = 3,
+    PAYLOAD_IMU_RX = 4,
+    PAYLOAD_TOF_TX = 5,
+    PAYLOAD_TOF_RX = 6,
+    PAYLOAD_CORAL_TX = 7,
+    PAYLOAD_CORAL_RX = 8,
+    PAYLOAD_LINK_TEST = 9,
+    PAYLOAD_MUX_LDR_TX = 10,
+};
+
+// Every payload sent to the Teensy starts with this header, so that it can tell
+// new packets from repeated or reordered ones and how old their data is
+struct __attribute__((packed, may_alias)) PacketHeader {
+    uint32_t time = 0;     // sender's micros() when the data was read
+    uint16_t sequence = 0; // incremented for every packet, rolls over
+
+    void advance(uint32_t now) {
+        time = now;
+        ++sequence;
+    }
+};
+static_assert(sizeof(PacketHeader) == 6, "PacketHeader is padded");
+
+struct __attribute__((packed, may_alias)) LineData {
+    LineData() : newData(true) {}
+
+    bool newData : 1;
+    uint8_t : 7;
+    int16_t angleBisector = NO_LINE_INT16; // -179(.)99° to 180(.)00°
+    uint8_t size = NO_LINE_UINT8;          // 0(.)00 to 1(.)00
+    uint8_t confidence = 0;                // 0(.)00 to 1(.)00
+    int16_t sizeRate = 0;                  // -327(.)68/s to 327(.)67/s
+    int16_t angleRate = 0;                 // -3276(.)8°/s to 3276(.)7°/s
+    uint16_t timeToCross = NO_CROSSING;    // in ms, until size is 1
+
+    bool exists() {
+        return angleBisector != NO_LINE_INT16 && size != NO_LINE_UINT8;
+    }
+};
+static_assert(sizeof(LineData) == 11, "LineData is padded");
+
+// Which LDRs are on the line, and how strongly a block of them sees it (the
+// blocks take turns, so each intensity is only sent every few packets)
+struct __attribute__((packed, may_alias)) LDRData {
+    uint32_t activations = 0;    // bit i is set if LDR i is on the line
+    uint8_t intensityBlock = 0;  // of LDR_INTENSITY_BLOCK_SIZE LDRs
+    uint8_t intensities[4] = {}; // two per byte, low nibble first
+
+    // Intensity of LDR i of the block, from 0 (field) to LDR_INTENSITY_MAX
+    // (line), or NO_LDR_INTENSITY if it hasn't been calibrated
+    uint8_t intensity(uint8_t i) const {
+        return intensities[i / 2] >> (i % 2 * 4) & 0xF;
+    }
+
+    void setIntensity(uint8_t i, uint8_t value) {
+        intensities[i / 2] &= 0xF0 >> (i % 2 * 4);
+        intensities[i / 2] |= (value & 0xF) << (i % 2 * 4);
+    }
+};
+static_assert(sizeof(LDRData) == 9, "LDRData is padded");
+
+struct __attribute__((packed, may_alias)) IMUData {
+    IMUData() : newData(true) {}
+
+    bool newData : 1;
+    uint8_t : 7;
+    int16_t robotAngle = NO_ANGLE; // -179(.)99º to +180(.)00º
+};
+static_assert(sizeof(IMUData) == 3, "IMUData is padded");
+
+struct __attribute__((packed, may_alias)) BoundsData {
+    BoundsData()
+        : frontNewData(true), backNewData(true), leftNewData(true),
+          rightNewData(true) {}
+
+    bool frontNewData : 1;
+    bool backNewData : 1;
+    bool leftNewData : 1;
+    bool rightNewData : 1;
+    uint8_t : 4;
+    uint16_t front = NO_BOUNDS; // 0(.)0 cm to 400(.)0 cm
+    uint16_t back = NO_BOUNDS;  // 0(.)0 cm to 400(.)0 cm
+    uint16_t left = NO_BOUNDS;  // 0(.)0 cm to 400(.)0 cm
+    uint16_t right = NO_BOUNDS; // 0(.)0 cm to 400(.)0 cm
+
+    void set(uint8_t index, uint16_t value = NO_BOUNDS) {
+        switch (index) {
+        case 0:
+            front = value;
+            frontNewData = value != NO_BOUNDS;
+            break;
+        case 1:
+            back = value;
+            backNewData = value != NO_BOUNDS;
+            break;
+        case 2:
+            left = value;
+            leftNewData = value != NO_BOUNDS;
+            break;
+        case 3:
+            right = value;
+            rightNewData = value != NO_BOUNDS;
+            break;
+        }
+    }
+
+    void markAsOld() {
+        frontNewData = false;
+        backNewData = false;
+        leftNewData = false;
+        rightNewData = false;
+    }
+};
+static_assert(sizeof(BoundsData) == 9, "BoundsData is padded");
+
+struct __attribute__((packed, may_alias)) CameraData {
+    CameraData() : newData(true) {}
+
+    bool newData : 1;
+    uint8_t : 7;
+    int16_t ballAngle = NO_BALL_INT16;            // -179(.)99° to 180(.)00°
+    uint16_t ballDistance = NO_BALL_UINT16;       // 0(.)0 cm to ~400(.)0 cm
+    int16_t blueGoalAngle = NO_BALL_INT16;        // -179(.)99° to 180(.)00°
+    uint16_t blueGoalDistance = NO_BALL_UINT16;   // 0(.)0 cm to ~400(.)0 cm
+    int16_t yellowGoalAngle = NO_BALL_INT16;      // -179(.)99° to 180(.)00°
+    uint16_t yellowGoalDistance = NO_BALL_UINT16; // 0(.)0 cm to ~400(.)0 cm
+};
+static_assert(sizeof(CameraData) == 13, "CameraData is padded");
+
+// This should be symmetric
+struct __attribute__((packed, may_alias)) BluetoothPayload {
+    BluetoothPayload() : newData(true), masterIsStriker(true) {}
+
+    bool newData : 1;
+    bool masterIsStriker : 1;
+    uint8_t : 6;
+    float ballAngle = NAN; // relative to field center
+    float ballDistance = NAN;
+    float robotAngle = NAN; // relative to field center
+    float robotDistance = NAN;
+
+    Vector ball() const { return {ballAngle, ballDistance}; }
+    Vector robot() const { return {robotAngle, robotDistance}; }
+
+    // Creates a new BluetoothPayload with newData set as true
+    static BluetoothPayload create(bool masterIsStriker, Vector ball,
+                                   Vector robot) {
+        BluetoothPayload newPayload;
+        newPayload.newData = true;
+        newPayload.masterIsStriker = masterIsStriker;
+        newPayload.ballAngle = ball.angle;
+        newPayload.ballDistance = ball.distance;
+        newPayload.robotAngle = robot.angle;
+        newPayload.robotDistance = robot.distance;
+        return newPayload;
+    }
+};
+static_assert(sizeof(BluetoothPayload) == 17, "BluetoothPayload is padded");
+
+// Parameters of the STM32 MUX that can be changed without reflashing it
+struct __attribute__((packed, may_alias)) MUXParameters {
+    uint16_t ldrThresholds[30] = {};       // one for each LDR
+    uint16_t activationThreshold = 0;      // in scans, see ldr_filter.h
+    float calibrationMultiplier = 0;       // 0 (green) to 1 (white)
+    uint16_t ldrFieldValues[30] = {};      // green, one for each LDR
+    uint16_t ldrLineValues[30] = {};       // white, one for each LDR
+    uint8_t analogLineEstimation = 0;      // 0 or 1, see findLine()
+    uint8_t adaptiveThresholds = 0;        // 0 or 1, see adaptLDRLevels()
+    uint8_t ldrFilter = LDR_FILTER_K_OF_N; // see ldr_filter.h
+    uint8_t ldrFilterWindow = 0;           // in scans
+    uint8_t deactivationThreshold = 0;     // in scans, for hysteresis
+};
+static_assert(sizeof(MUXParameters) == 191, "MUXParameters is padded");
+
+struct __attribute__((packed, may_alias)) MUXTXPayload {
+    MUXTXPayload() : commandFailed(false) {}
+
+    PacketHeader header;
+    LineData line;
+    uint8_t commandId = 0; // of the last command carried out, 0 if none
+    bool commandFailed : 1;
+    uint8_t : 7;
+    int16_t thresholdDrift = 0;    // in ADC counts, see adaptLDRLevels()
+    uint8_t thresholdDriftLDR = 0; // whose threshold drifted most
+};
+static_assert(sizeof(MUXTXPayload) == 22, "MUXTXPayload is padded");
+
+// Sent by the STM32 MUX instead of MUXTXPayload with MUX_LDR_DATA (see
+// shared_config.h)
+struct __attribute__((packed, may_alias)) MUXLDRTXPayload {
+    MUXLDRTXPayload() : commandFailed(false) {}
+
+    PacketHeader header;
+    LineData line;
+    uint8_t commandId = 0; // of the last command carried out, 0 if none
+    bool commandFailed : 1;
+    uint8_t : 7;
+    int16_t thresholdDrift = 0;    // in ADC counts, see adaptLDRLevels()
+    uint8_t thresholdDriftLDR = 0; // whose threshold drifted most
+    LDRData ldrs;
+};
+static_assert(sizeof(MUXLDRTXPayload) == 31, "MUXLDRTXPayload is padded");
+
+// A command for the STM32 MUX, which carries it out once for each commandId and
+// acknowledges it in MUXTXPayload. Parameters are uploaded as chunks of
+// MUXParameters, then saved.
+struct __attribute__((packed, may_alias)) MUXRXPayload {
+    uint8_t command = MUX_COMMAND_NONE;
+    uint8_t commandId = 0; // 1 to 255, as 0 means none
+    uint8_t offset = 0;    // of data in MUXParameters, in bytes
+    uint8_t data[MUX_PARAMETER_CHUNK_SIZE] = {};
+};
+static_assert(sizeof(MUXRXPayload) == 19, "MUXRXPayload is padded");
+
+struct __attribute__((packed, may_alias)) IMUTXPayload {
+    PacketHeader header;
+    IMUData imu;
+};
+static_assert(sizeof(IMUTXPayload) == 9, "IMUTXPayload is padded");
+
+struct __attribute__((packed, may_alias)) IMURXPayload {
+    IMURXPayload() : calibrating(false) {}
+
+    bool calibrating : 1;
+    uint8_t : 7;
+};
+static_assert(sizeof(IMURXPayload) == 1, "IMURXPayload is padded");
+
+struct __attribute__((packed, may_alias)) TOFTXPayload {
+    PacketHeader header;
+    BoundsData bounds;
+    BluetoothPayload bluetoothInboundPayload;
+};
+static_assert(sizeof(TOFTXPayload) == 32, "TOFTXPayload is padded");
+
+struct __attribute__((packed, may_alias)) TOFRXPayload {
+    BluetoothPayload bluetoothOutboundPayload;
+};
+static_assert(sizeof(TOFRXPayload) == 17, "TOFRXPayload is padded");
+
+struct __attribute__((packed, may_alias)) CoralTXPayload {
+    PacketHeader header;
+    CameraData camera;
+};
+static_assert(sizeof(CoralTXPayload) == 19, "CoralTXPayload is padded");
+
+// Sent to the Coral at a fixed rate so that it can compensate its tracking for
+// the robot's own motion
+struct __attribute__((packed, may_alias)) CoralRXPayload {
+    int16_t heading = NO_ANGLE;   // -179(.)99° to 180(.)00°
+    int16_t headingRate = 0;      // -3276(.)8°/s to 3276(.)7°/s
+    int16_t movementAngle = 0;    // -179(.)99° to 180(.)00°, relative
+    int16_t movementVelocity = 0; // ±35 to ±1023, 0 to stop
+
+    // heading and rate in º and º/s
+    void setHeading(float heading, float rate) {
+        this->heading = BinaryAngle::fromDegrees(heading).centidegrees();
+        headingRate = roundf(fminf(fmaxf(rate * 10, INT16_MIN), INT16_MAX));
+    }
+
+    // angle in º relative to the front of the robot, as in Movement
+    void setMovement(float angle, int16_t velocity) {
+        movementAngle = BinaryAngle::fromDegrees(angle).centidegrees();
+        movementVelocity = velocity;
+    }
+};
+static_assert(sizeof(CoralRXPayload) == 8, "CoralRXPayload is padded");
+
+// Sent by the Teensy to negotiate the baud rate of a link, and echoed back by
+// the STM32 (see link_test.h)
+struct __attribute__((packed, may_alias)) LinkTestPayload {
+    uint8_t command = LINK_TEST_PING;
+    uint16_t sequence = 0;
+    uint32_t baudRate = 0; // to switch to
+    uint8_t pattern[LINK_TEST_PATTERN_SIZE] = {};
+};
+static_assert(sizeof(LinkTestPayload) == 39, "LinkTestPayload is padded");
+
+// Payload type ID of each payload struct, e.g. PayloadTypeOf<MUXTXPayload>
+template <typename Payload> struct PayloadTypeOf;
+template <> struct PayloadTypeOf<MUXTXPayload> {
+    static constexpr PayloadType value = PAYLOAD_MUX_TX;
+};
+template <> struct PayloadTypeOf<MUXRXPayload> {
+    static constexpr PayloadType value = PAYLOAD_MUX_RX;
+};
+template <> struct PayloadTypeOf<IMUTXPayload> {
+    static constexpr PayloadType value = PAYLOAD_IMU_TX;
+};
+template <> struct PayloadTypeOf<IMURXPayload> {
+    static constexpr PayloadType value = PAYLOAD_IMU_RX;
+};
+template <> struct PayloadTypeOf<TOFTXPayload> {
+    static constexpr PayloadType value = PAYLOAD_TOF_TX;
+};
+template <> struct PayloadTypeOf<TOFRXPayload> {
+    static constexpr PayloadType value = PAYLOAD_TOF_RX;
+};
+template <> struct PayloadTypeOf<CoralTXPayload> {
+    static constexpr PayloadType value = PAYLOAD_CORAL_TX;
+};
+template <> struct PayloadTypeOf<CoralRXPayload> {
+    static constexpr PayloadType value = PAYLOAD_CORAL_RX;
+};
+template <> struct PayloadTypeOf<LinkTestPayload> {
+    static constexpr PayloadType value = PAYLOAD_LINK_TEST;
+};
+template <> struct PayloadTypeOf<MUXLDRTXPayload> {
+    static constexpr PayloadType value = PAYLOAD_MUX_LDR_TX;
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <Arduino.h>
 
+#include "telemetry.h"
+
 class PIDController {
   public:
     PIDController(const float setpoint, const float min, const float max,
@@ -19,8 +21,9 @@ class PIDController {
     void updateSetpoint(const float value);
     void updateLimits(const float min, const float max);
     void updateGains(const float kp, const float ki, const float kd);
+    void setFixedDt(const uint32_t dt);
 
-    void debugPrint(const char *name = nullptr, Stream &serial = Serial);
+    void sendTelemetry(Telemetry &telemetry, const uint8_t id) const;
 
     float currentSetpoint() const { return _setpoint; }
 
@@ -34,6 +37,7 @@ class PIDController {
     float _ki;
     float _kd;
     uint32_t _minDt;
+    uint32_t _fixedDt = 0; // in µs, 0 to measure dt instead
     float _maxi;
     float _maxSetpointChange;
     // Internal values
@@ -42,7 +46,7 @@ class PIDController {
     uint32_t _lastTime = 0;
     float _lastOutput = 0.0F;
     bool _justStarted = true;
-    // For debugging
+    // For telemetry
     float _lastInput = 0.0F;
     float _lastP = 0.0F;
     float _lastI = 0.0F;
@@ -0,0 +1,87 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+
+#ifdef ARM_DWT_CYCCNT
+    #define PROFILER_CYCLES()         ARM_DWT_CYCCNT
+    #define PROFILER_CYCLES_PER_MICRO (F_CPU_ACTUAL / 1000000)
+#else
+    // Without a cycle counter, fall back to counting µs
+    #define PROFILER_CYCLES()         micros()
+    #define PROFILER_CYCLES_PER_MICRO 1
+#endif
+
+// Histogram buckets are exact below 2^PROFILER_SUB_BUCKET_BITS cycles, and
+// split every power of two into 2^PROFILER_SUB_BUCKET_BITS buckets above that
+// (≤ 12.5% error) below 2^(PROFILER_MAX_BITS + 1) cycles (~0.9 s at 600 MHz)
+#define PROFILER_SUB_BUCKET_BITS 3
+#define PROFILER_MAX_BITS        28
+#define PROFILER_BUCKET_COUNT                                                  \
+    ((PROFILER_MAX_BITS - PROFILER_SUB_BUCKET_BITS + 2)                        \
+     << PROFILER_SUB_BUCKET_BITS)
+
+// A named section of code whose execution times (in cycles) are collected in a
+// fixed-size histogram. Zones register themselves on construction, so define
+// them as globals.
+class ProfilerZone {
+  public:
+    explicit ProfilerZone(const char *name);
+
+    void record(const uint32_t cycles);
+    void reset();
+
+    const char *name() const { return _name; }
+    uint32_t count() const { return _count; }
+    uint32_t mean() const; // in cycles
+    uint32_t percentile(const float p) const; // in cycles, p from 0 to 100
+    uint32_t max() const { return _max; }     // in cycles
+
+    // All zones, in order of registration
+    static ProfilerZone *first() { return _first; }
+    ProfilerZone *next() const { return _next; }
+
+  private:
+    static uint16_t _bucket(const uint32_t cycles);
+    static uint32_t _bucketMidpoint(const uint16_t bucket);
+
+    const char *_name;
+    std::array<uint32_t, PROFILER_BUCKET_COUNT> _histogram = {};
+    uint32_t _count = 0;
+    uint32_t _max = 0;
+    uint64_t _total = 0;
+
+    ProfilerZone *_next = nullptr;
+    static ProfilerZone *_first;
+};
+
+// Records the time from its construction to its destruction into a zone.
+class ProfilerScope {
+  public:
+    explicit ProfilerScope(ProfilerZone &zone)
+        : _zone(zone), _start(PROFILER_CYCLES()) {}
+    ~ProfilerScope() { _zone.record(PROFILER_CYCLES() - _start); }
+
+  private:
+    ProfilerZone &_zone;
+    const uint32_t _start;
+};
+
+// Profiles the rest of the enclosing scope if PROFILE is defined (include the
+// config defining it before this header)
+#define _PROFILE_SCOPE_NAME(line) _profilerScope##line
+#define _PROFILE_SCOPE(zone, line)                                             \
+    ProfilerScope _PROFILE_SCOPE_NAME(line)(zone)
+#ifdef PROFILE
+    #define PROFILE_SCOPE(zone) _PROFILE_SCOPE(zone, __LINE__)
+#else
+    #define PROFILE_SCOPE(zone)
+#endif
+
+void initProfiler();
+void printProfile(Stream &serial = Serial);
+void resetProfile();
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+
+#define SCHEDULER_MAX_TASKS 8
+
+// A cooperative scheduler that runs tasks at fixed periods in order of
+// priority, keeping track of deadline misses and execution times.
+class Scheduler {
+  public:
+    typedef void (*TaskFunction)();
+
+    // Adds a task (lower priority values run first)
+    bool add(const char *name, TaskFunction function, const uint32_t period,
+             const uint8_t priority);
+
+    // Runs whenever run() finds no task released, e.g. to flush buffers
+    void setIdleTask(TaskFunction function) { _idleFunction = function; }
+
+    // Call repeatedly from loop()
+    void run();
+    // Runs every task once regardless of its period, e.g. for benchmarking
+    void runAll();
+
+    void printStats(Stream &serial = Serial) const;
+    void resetStats();
+
+  private:
+    struct Task {
+        const char *name;
+        TaskFunction function;
+        uint32_t period; // in µs
+        uint8_t priority;
+        uint32_t nextRelease = 0;
+        // Statistics
+        uint32_t runs = 0;
+        uint32_t misses = 0;
+        uint32_t lastExecutionTime = 0; // in µs
+        uint32_t maxExecutionTime = 0;  // in µs, worst case
+        uint64_t totalExecutionTime = 0;
+    };
+
+    uint32_t _execute(Task &task);
+
+    std::array<Task, SCHEDULER_MAX_TASKS> _tasks;
+    uint8_t _taskCount = 0;
+    TaskFunction _idleFunction = nullptr;
+};
+
+#endif
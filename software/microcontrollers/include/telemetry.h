@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Frames waiting to be sent are kept in a ring buffer of this many bytes
+#ifndef TELEMETRY_BUFFER_SIZE
+    #define TELEMETRY_BUFFER_SIZE 8192
+#endif
+#define TELEMETRY_MAX_RECORD_SIZE 64
+
+// NULL values
+#define TELEMETRY_NO_INT16  INT16_MAX
+#define TELEMETRY_NO_UINT16 UINT16_MAX
+
+// Every frame starts with the record type and the time it was recorded, and is
+// COBS-encoded with a zero delimiter like the other serial links.
+// Keep in sync with tools/telemetry.py!
+enum TelemetryRecordType : uint8_t {
+    TELEMETRY_SENSORS = 1,
+    TELEMETRY_MOVEMENT = 2,
+    TELEMETRY_PID = 3,
+};
+struct __attribute__((packed)) TelemetryHeader {
+    uint8_t type;
+    uint32_t time; // in µs
+};
+
+// Snapshot of the processed sensor data
+struct __attribute__((packed)) TelemetrySensorsRecord {
+    static const uint8_t TYPE = TELEMETRY_SENSORS;
+
+    int16_t robotAngle = TELEMETRY_NO_INT16;        // -179(.)99º to 180(.)00º
+    int16_t robotX = TELEMETRY_NO_INT16;            // in (.)0 cm from center
+    int16_t robotY = TELEMETRY_NO_INT16;            // in (.)0 cm from center
+    int16_t lineAngleBisector = TELEMETRY_NO_INT16; // -179(.)99º to 180(.)00º
+    uint8_t lineDepth = 0;                          // 0(.)00 to 2(.)55
+    uint16_t boundFront = TELEMETRY_NO_UINT16;      // 0(.)0 cm to 400(.)0 cm
+    uint16_t boundBack = TELEMETRY_NO_UINT16;       // 0(.)0 cm to 400(.)0 cm
+    uint16_t boundLeft = TELEMETRY_NO_UINT16;       // 0(.)0 cm to 400(.)0 cm
+    uint16_t boundRight = TELEMETRY_NO_UINT16;      // 0(.)0 cm to 400(.)0 cm
+    int16_t ballAngle = TELEMETRY_NO_INT16;         // -179(.)99º to 180(.)00º
+    uint16_t ballDistance = TELEMETRY_NO_UINT16;    // from 0(.)0 cm
+    int16_t offensiveGoalAngle = TELEMETRY_NO_INT16;
+    uint16_t offensiveGoalDistance = TELEMETRY_NO_UINT16;
+    int16_t defensiveGoalAngle = TELEMETRY_NO_INT16;
+    uint16_t defensiveGoalDistance = TELEMETRY_NO_UINT16;
+    bool hasBall = false;
+    bool masterIsStriker = false;
+};
+
+// What the robot has been told to do
+struct __attribute__((packed)) TelemetryMovementRecord {
+    static const uint8_t TYPE = TELEMETRY_MOVEMENT;
+
+    int16_t angle;           // -179(.)99º to 180(.)00º
+    int16_t velocity;        // ±35 to ±1023
+    int16_t heading;         // -179(.)99º to 180(.)00º
+    int16_t actualHeading;   // -179(.)99º to 180(.)00º
+    int16_t angularVelocity; // ±1023
+    bool dribble;
+    bool brake;
+};
+
+// Internal values of a PID controller after it was last advanced
+struct __attribute__((packed)) TelemetryPIDRecord {
+    static const uint8_t TYPE = TELEMETRY_PID;
+
+    uint8_t id; // which controller
+    float setpoint;
+    float input;
+    float error;
+    float output;
+    float p;
+    float i;
+    float d;
+    uint32_t dt; // in µs
+};
+
+// Buffers COBS-framed telemetry records so that they can be sent whenever the
+// loop has time to spare.
+class Telemetry {
+  public:
+    template <typename Record> bool send(const Record &record) {
+        static_assert(sizeof(Record) <= TELEMETRY_MAX_RECORD_SIZE,
+                      "Telemetry record is too large");
+        return push(Record::TYPE, (const uint8_t *)&record, sizeof(record));
+    }
+    bool push(const uint8_t type, const uint8_t *record, const size_t size);
+
+    // Writes as much of the buffer as the stream can take without blocking
+    size_t drain(Stream &serial = Serial);
+
+    size_t buffered() const;
+    uint32_t dropped() const { return _dropped; }
+
+  private:
+    std::array<uint8_t, TELEMETRY_BUFFER_SIZE> _buffer;
+    size_t _head = 0; // next byte to write into
+    size_t _tail = 0; // next byte to send
+    uint32_t _dropped = 0;
+};
+
+#endif
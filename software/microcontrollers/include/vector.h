@@ -32,4 +32,46 @@ class Vector {
     bool exists() const { return !std::isnan(angle) && !std::isnan(distance); }
 };
 
+// A vector stored in cartesian form (x to the right, y to the front), so that
+// arithmetic needs no trigonometry. Its polar form is computed on demand and
+// cached, as x and y never change after construction.
+class CartesianVector {
+  public:
+    CartesianVector(float x = NAN, float y = NAN) : _x(x), _y(y) {}
+    CartesianVector(const Vector &vector);
+    static CartesianVector fromPoint(Point point) { return {point.x, point.y}; }
+
+    float x() const { return _x; }
+    float y() const { return _y; }
+    float angle() const;    // -179.99º to +180.00º
+    float distance() const; // ≥ 0
+    Vector toVector() const { return {angle(), distance()}; }
+    Point toPoint() const { return {_x, _y}; }
+
+    CartesianVector operator+(const CartesianVector &other) const {
+        return {_x + other._x, _y + other._y};
+    }
+    CartesianVector operator-() const { return {-_x, -_y}; }
+    CartesianVector operator-(const CartesianVector &other) const {
+        return {_x - other._x, _y - other._y};
+    }
+    CartesianVector operator*(const float other) const {
+        return {_x * other, _y * other};
+    }
+    CartesianVector operator/(const float other) const {
+        return {_x / other, _y / other};
+    }
+
+    bool exists() const { return !std::isnan(_x) && !std::isnan(_y); }
+
+  private:
+    float _x;
+    float _y;
+    // Cached polar form (flags rather than NAN, as -Ofast assumes no NANs)
+    mutable bool _hasAngle = false;
+    mutable bool _hasDistance = false;
+    mutable float _angle;
+    mutable float _distance;
+};
+
 #endif
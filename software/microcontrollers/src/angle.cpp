@@ -2,14 +2,17 @@
 
 #include <cmath>
 #include <cstdint>
-#include <wiring.h>
+
+// Everything here is single precision, as the Teensy's FPU only does floats in
+// hardware and falls back to (much slower) software for doubles.
 
 // Bearings are easier to do math with...
 
 // Ensures that the bearing is between 0.0F and 360.0F.
 float clipBearing(float dividend) {
-    const auto r = fmodf(dividend, 360.0);
-    return r < 0 ? r + 360.0 : r;
+    const auto r = dividend - 360.0F * floorf(dividend * (1.0F / 360.0F));
+    // Rounding can push tiny negative dividends up to 360.0F
+    return r >= 360.0F ? r - 360.0F : r;
 }
 
 // Returns the difference between two angles, between 0.0F and 360.0F.
@@ -20,12 +23,12 @@ float bearingDiff(float leftAngle, float rightAngle) {
 // Returns the smaller of two angle differences, between 0.0F and 180.0F.
 float smallerBearingDiff(float leftAngle, float rightAngle) {
     const auto angle = bearingDiff(leftAngle, rightAngle);
-    return fmin(angle, 360 - angle);
+    return fminf(angle, 360.0F - angle);
 }
 
 // Returns the midpoint of two angles, between 0.0F and 360.0F.
 float bearingMidpoint(float leftAngle, float rightAngle) {
-    return clipBearing(leftAngle + bearingDiff(leftAngle, rightAngle) / 2.0);
+    return clipBearing(leftAngle + bearingDiff(leftAngle, rightAngle) / 2.0F);
 }
 
 // Angles are easier for the robot to understand...
@@ -36,14 +39,90 @@ float bearingToAngle(float bearing) {
 
 // Ensures that the angle is between -179.99F and +180.00F.
 float clipAngle(float dividend) {
-    const auto r = fmod(dividend, 360);
-    return r <= -180 ? r + 360 : r > 180 ? r - 360 : r;
+    const auto r = dividend - 360.0F * roundf(dividend * (1.0F / 360.0F));
+    return r <= -180.0F ? r + 360.0F : r > 180.0F ? r - 360.0F : r;
 }
 
 // Keep everything in degrees...
 
-float sinfd(float x) { return sin(x * DEG_TO_RAD); }
+// Computes sin and cos together with a single range reduction. The angle is
+// reduced exactly to ±45º around the nearest multiple of 90º, where Taylor
+// polynomials of degree 9 (sin) and 8 (cos) are accurate to within 1.2e-7
+// (absolute), about one float ulp.
+void sincosfd(float x, float &sine, float &cosine) {
+    // Non-finite angles have no sine or cosine, and huge ones are reduced to
+    // a turn first so that the quadrant fits in an int32_t
+    const auto exponent = floatExponent(x);
+    if (exponent == FLOAT_EXPONENT_NONFINITE) {
+        sine = cosine = NAN;
+        return;
+    }
+    if (exponent >= FLOAT_EXPONENT_WHOLE) x = fmodf(x, 360.0F);
+    const auto quadrant = roundf(x * (1.0F / 90.0F));
+    const auto t = (x - 90.0F * quadrant) * DEG_TO_RADF;
+    const auto t2 = t * t;
+    const auto s =
+        t * (1.0F +
+             t2 * (-1.0F / 6 +
+                   t2 * (1.0F / 120 +
+                         t2 * (-1.0F / 5040 + t2 * (1.0F / 362880)))));
+    const auto c =
+        1.0F +
+        t2 * (-1.0F / 2 +
+              t2 * (1.0F / 24 + t2 * (-1.0F / 720 + t2 * (1.0F / 40320))));
+
+    // Rotate the result back into the right quadrant
+    switch ((int32_t)quadrant & 3) {
+    case 0:
+        sine = s;
+        cosine = c;
+        break;
+    case 1:
+        sine = c;
+        cosine = -s;
+        break;
+    case 2:
+        sine = -s;
+        cosine = -c;
+        break;
+    default:
+        sine = -c;
+        cosine = s;
+        break;
+    }
+}
+
+float sinfd(float x) {
+    float sine, cosine;
+    sincosfd(x, sine, cosine);
+    return sine;
+}
+
+float cosfd(float x) {
+    float sine, cosine;
+    sincosfd(x, sine, cosine);
+    return cosine;
+}
 
-float cosfd(float x) { return cos(x * DEG_TO_RAD); }
+// Computes atan2(x, y) in degrees between -179.99F and +180.00F. The ratio of
+// the smaller to the larger magnitude is fed to a degree 11 minimax polynomial
+// for atan on [0, 1], accurate to within 2e-6 rad (1.2e-4º).
+float atan2fd(float x, float y) {
+    const auto absX = fabsf(x), absY = fabsf(y);
+    const auto larger = fmaxf(absX, absY);
+    if (larger == 0) return 0;
+    const auto a = fminf(absX, absY) / larger;
+    const auto s = a * a;
+    auto r = a *
+             (0.99997726F +
+              s * (-0.33262347F +
+                   s * (0.19354346F +
+                        s * (-0.11643287F +
+                             s * (0.05265332F + s * -0.01172120F))))) *
+             RAD_TO_DEGF;
 
-float atan2fd(float x, float y) { return clipAngle(atan2(x, y) * RAD_TO_DEG); }
+    // Unfold the octant
+    if (absX > absY) r = 90.0F - r;
+    if (y < 0) r = 180.0F - r;
+    return x < 0 ? -r : r;
+}
@@ -0,0 +1,78 @@
+#include "flight_recorder.h"
+
+#include <Arduino.h>
+#include <PacketSerial.h>
+#include <algorithm>
+
+// Appends an entry, dropping the oldest entries to make space for it.
+void FlightRecorder::record(const uint8_t source, const uint32_t time,
+                            const uint8_t *data, const size_t size) {
+    if (_dumping || size > FLIGHT_RECORDER_MAX_DATA_SIZE) return;
+
+    const FlightRecorderEntryHeader header = {source, time, (uint16_t)size};
+    const auto entrySize = sizeof(header) + size;
+    if (entrySize >= _size) return;
+    while (_size - 1 - used() < entrySize) _dropOldest();
+
+    _write((const uint8_t *)&header, sizeof(header));
+    _write(data, size);
+    ++_entries;
+}
+
+void FlightRecorder::dump(Stream &serial) {
+    _dumping = true;
+
+    byte entry[sizeof(FlightRecorderEntryHeader) +
+               FLIGHT_RECORDER_MAX_DATA_SIZE];
+    byte encoded[sizeof(entry) + sizeof(entry) / 254 + 2];
+    const auto send = [&](size_t size) {
+        const auto encodedSize = COBS::encode(entry, size, encoded);
+        encoded[encodedSize] = 0; // delimiter byte
+        serial.write(encoded, encodedSize + 1);
+    };
+
+    // Go through the entries without consuming them, so that they can be
+    // dumped again
+    for (auto position = _tail; position != _head;) {
+        FlightRecorderEntryHeader header;
+        _read(position, (uint8_t *)&header, sizeof(header));
+        const auto size = sizeof(header) + header.size;
+        _read(position, entry, size);
+        send(size);
+        position = (position + size) % _size;
+    }
+
+    const FlightRecorderEntryHeader end = {FLIGHT_RECORDER_END, micros(), 0};
+    memcpy(entry, &end, sizeof(end));
+    send(sizeof(end));
+
+    _dumping = false;
+}
+
+void FlightRecorder::clear() {
+    _head = 0;
+    _tail = 0;
+    _entries = 0;
+}
+
+void FlightRecorder::_write(const uint8_t *data, const size_t size) {
+    // Copy in at most two contiguous parts
+    const auto first = std::min(size, _size - _head);
+    memcpy(_buffer + _head, data, first);
+    memcpy(_buffer, data + first, size - first);
+    _head = (_head + size) % _size;
+}
+
+void FlightRecorder::_read(size_t position, uint8_t *data,
+                           const size_t size) const {
+    const auto first = std::min(size, _size - position);
+    memcpy(data, _buffer + position, first);
+    memcpy(data + first, _buffer, size - first);
+}
+
+void FlightRecorder::_dropOldest() {
+    FlightRecorderEntryHeader header;
+    _read(_tail, (uint8_t *)&header, sizeof(header));
+    _tail = (_tail + sizeof(header) + header.size) % _size;
+    --_entries;
+}
@@ -0,0 +1,72 @@
+#include "ldr_filter.h"
+
+static_assert(LDR_FILTER_MAX_WINDOW < 1 << LDR_FILTER_COUNT_BITS,
+              "The counters must count every scan in the window");
+
+bool LDRFilter::valid(const uint8_t policy, const uint8_t window,
+                      const uint8_t onThreshold, const uint8_t offThreshold) {
+    if (window == 0 || window > LDR_FILTER_MAX_WINDOW || onThreshold == 0 ||
+        onThreshold > window)
+        return false;
+    switch (policy) {
+    case LDR_FILTER_K_OF_N:
+        return true;
+    case LDR_FILTER_HYSTERESIS:
+        return offThreshold < onThreshold;
+    default:
+        return false;
+    }
+}
+
+void LDRFilter::configure(const uint8_t policy, const uint8_t window,
+                          const uint8_t onThreshold,
+                          const uint8_t offThreshold) {
+    _window = window;
+    _onThreshold = onThreshold;
+    // k-of-n is hysteresis that turns off as soon as it would no longer turn on
+    _offThreshold =
+        policy == LDR_FILTER_HYSTERESIS ? offThreshold : onThreshold - 1;
+    reset();
+}
+
+void LDRFilter::reset() {
+    _history.fill(0);
+    _head = 0;
+    _counts.fill(0);
+    _state = 0;
+}
+
+uint32_t LDRFilter::update(const uint32_t hits) {
+    // Count the oldest scan out of the window and the new one in, rippling the
+    // borrows and carries through the bits of every counter at once (out
+    // first, so that they never overflow)
+    uint32_t borrow = _history[_head];
+    uint32_t carry = hits;
+    for (auto &bit : _counts) {
+        const auto difference = bit ^ borrow;
+        borrow &= ~bit;
+        const auto sum = difference ^ carry;
+        carry &= difference;
+        bit = sum;
+    }
+    _history[_head] = hits;
+    _head = (_head + 1) % _window;
+
+    _state = _atLeast(_onThreshold) | (_state & _atLeast(_offThreshold + 1));
+    return _state;
+}
+
+// Returns the LDRs hit in at least count of the last window scans.
+uint32_t LDRFilter::_atLeast(const uint8_t count) const {
+    // Compare every counter with count from the most significant bit down
+    uint32_t greater = 0, equal = ~0U;
+    for (int8_t b = LDR_FILTER_COUNT_BITS - 1; b >= 0; --b) {
+        if (count >> b & 1) {
+            equal &= _counts[b];
+        } else {
+            greater |= equal & _counts[b];
+            equal &= ~_counts[b];
+        }
+    }
+    return greater | equal;
+}
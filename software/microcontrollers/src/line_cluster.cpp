@@ -0,0 +1,51 @@
+#include "line_cluster.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool findLineCluster(const float *bearings, const uint8_t *matches,
+                     const uint8_t matchCount, uint8_t &start, uint8_t &end) {
+    if (matchCount < 2) return false;
+
+    // Angle between two matches, ≤ 180º
+    const auto difference = [&](uint8_t i, uint8_t j) {
+        const auto angle = fabsf(bearings[matches[i]] - bearings[matches[j]]);
+        return angle > 180 ? 360 - angle : angle;
+    };
+    // Bearing of the kth match going around the circle twice
+    const auto unwrapped = [&](uint16_t k) {
+        return k < matchCount ? bearings[matches[k]]
+                              : bearings[matches[k - matchCount]] + 360;
+    };
+
+    // The difference to match i grows until the opposite bearing and shrinks
+    // after it, so the match furthest from i is one of the two either side of
+    // it. The opposite bearing only moves forward as i does, so k does too.
+    float maxDifference = 0;
+    uint8_t first = 0, second = 0;
+    uint16_t k = 1;
+    for (uint8_t i = 0; i < matchCount; ++i) {
+        const auto opposite = bearings[matches[i]] + 180;
+        if (k <= i) k = i + 1;
+        while (k < i + matchCount && unwrapped(k) < opposite) ++k;
+        for (auto candidate = k - 1; candidate <= k; ++candidate) {
+            if (candidate <= i || candidate >= i + matchCount) continue;
+            // Order the pair by index, as ties go to the first
+            const uint8_t j = candidate % matchCount;
+            const auto a = std::min(i, j), b = std::max(i, j);
+            const auto angle = difference(a, b);
+            if (angle > maxDifference ||
+                (angle == maxDifference && maxDifference > 0 &&
+                 (a < first || (a == first && b < second)))) {
+                maxDifference = angle;
+                first = a;
+                second = b;
+            }
+        }
+    }
+    if (maxDifference == 0) return false;
+
+    start = matches[first];
+    end = matches[second];
+    return true;
+}
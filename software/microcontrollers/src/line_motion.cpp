@@ -0,0 +1,114 @@
+#include "line_motion.h"
+
+#include <algorithm>
+#include <cmath>
+
+void LineMotion::reset() {
+    _ends[0] = Track();
+    _ends[1] = Track();
+}
+
+// Until both ends have moved, one of them (turning with the robot, say) would
+// pass for the line growing or shrinking
+float LineMotion::sizeRate() const {
+    if (!_ends[0].rated || !_ends[1].rated) return 0;
+    return (_ends[_clockwise].rate - _ends[1 - _clockwise].rate) *
+           (1.0F / 180.0F);
+}
+
+float LineMotion::angleRate() const {
+    if (!_ends[0].rated || !_ends[1].rated) return 0;
+    return (_ends[0].rate + _ends[1].rate) / 2;
+}
+
+void LineMotion::update(LineData &line, const BinaryAngle start,
+                        const BinaryAngle end, const uint32_t time) {
+    if (!line.exists()) {
+        reset();
+        line.sizeRate = 0;
+        line.angleRate = 0;
+        line.timeToCross = NO_CROSSING;
+        return;
+    }
+
+    // Match the ends to the ones they were closest to last time
+    BinaryAngle ends[2] = {start, end};
+    if (_ends[0].count > 0) {
+        const auto distance = [](const BinaryAngle a, const BinaryAngle b) {
+            return (uint32_t)(a - b).abs().raw();
+        };
+        if (distance(ends[0], _ends[1].value) +
+                distance(ends[1], _ends[0].value) <
+            distance(ends[0], _ends[0].value) +
+                distance(ends[1], _ends[1].value))
+            std::swap(ends[0], ends[1]);
+    }
+    _update(_ends[0], ends[0], time);
+    _update(_ends[1], ends[1], time);
+    _clockwise = (int16_t)(ends[1] - ends[0]).raw() >= 0 ? 1 : 0;
+
+    const auto sizeRate = this->sizeRate();
+    const auto angleRate = this->angleRate();
+    line.sizeRate = fminf(fmaxf(roundf(sizeRate * 100), INT16_MIN), INT16_MAX);
+    line.angleRate = fminf(fmaxf(roundf(angleRate * 10), INT16_MIN), INT16_MAX);
+    if (sizeRate > _config.minApproachRate) {
+        // Over the middle already is now, and NO_CROSSING or more is never
+        const auto size = (end - start).abs().raw() / 32768.0F;
+        const auto timeToCross = fmaxf((1 - size) / sizeRate * 1000, 0);
+        line.timeToCross = fminf(roundf(timeToCross), NO_CROSSING);
+    } else {
+        line.timeToCross = NO_CROSSING;
+    }
+}
+
+void LineMotion::_update(Track &track, const BinaryAngle value,
+                         const uint32_t time) {
+    if (track.count > 0) {
+        const auto change = (value - track.value).degrees();
+        if (fabsf(change) < _config.minStep) {
+            // Not a move yet, but it would have moved by now if its rate were
+            // any higher
+            const auto dt = (time - track.times[track.count - 1]) * 1e-6F;
+            if (dt > 0) {
+                const auto limit = fmaxf(track.step, _config.minStep) / dt;
+                track.rate = fminf(fmaxf(track.rate, -limit), limit);
+            }
+            return;
+        }
+        if (fabsf(change) > _config.maxEndMove) {
+            // Too far to be a move, so start over from here (keeping the rate)
+            track.count = 0;
+        } else {
+            track.step = fabsf(change);
+        }
+    }
+    if (track.count == 0) {
+        track.positions[0] = 0;
+        track.firstSeen = true;
+    } else if (track.count == track.positions.size()) {
+        // Drop the oldest position
+        std::copy(track.positions.begin() + 1, track.positions.end(),
+                  track.positions.begin());
+        std::copy(track.times.begin() + 1, track.times.end(),
+                  track.times.begin());
+        --track.count;
+        track.firstSeen = false;
+    }
+    const auto last = track.count;
+    if (last > 0)
+        track.positions[last] =
+            track.positions[last - 1] + (value - track.value).degrees();
+    track.times[last] = time;
+    track.value = value;
+    ++track.count;
+
+    // Measure the rate from the first move kept to this one
+    const uint8_t first = track.firstSeen ? 1 : 0;
+    if (last <= first) return;
+    const auto dt = (time - track.times[first]) * 1e-6F;
+    if (dt <= 0) return;
+    const auto rate = (track.positions[last] - track.positions[first]) / dt;
+    track.rate =
+        track.rated ? track.rate + (rate - track.rate) * _config.gain : rate;
+    track.rated = true;
+}
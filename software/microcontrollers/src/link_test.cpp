@@ -0,0 +1,206 @@
+#include "link_test.h"
+
+#include <cstring>
+
+#include "framing.h"
+
+// ---------------------------------- Teensy ----------------------------------
+
+// The last link test payload echoed back
+static LinkTestPayload reply;
+static bool replied = false;
+
+static void onReply(const uint8_t *frame, size_t size) {
+    const uint8_t *payload;
+    size_t payloadSize;
+    if (!decodeFrame(frame, size, PAYLOAD_LINK_TEST, payload, payloadSize) ||
+        payloadSize != sizeof(reply))
+        return;
+    memcpy(&reply, payload, sizeof(reply));
+    replied = true;
+}
+
+// Sends a payload and waits for it to be echoed back.
+static bool exchange(PacketSerial &packetSerial, const LinkTestPayload &payload,
+                     const uint32_t timeout) {
+    replied = false;
+    sendFrame(packetSerial, PAYLOAD_LINK_TEST, payload);
+    const auto startTime = micros();
+    while (micros() - startTime < timeout) {
+        packetSerial.update();
+        // Ignore late echoes of earlier payloads
+        if (replied && memcmp(&reply, &payload, sizeof(payload)) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Sends a command until it is echoed back.
+static bool sendCommand(PacketSerial &packetSerial, const uint8_t command,
+                        const uint32_t baudRate = 0) {
+    LinkTestPayload payload;
+    payload.command = command;
+    payload.baudRate = baudRate;
+    for (uint8_t attempt = 0; attempt < LINK_TEST_RETRIES; ++attempt)
+        if (exchange(packetSerial, payload, LINK_TEST_REPLY_TIMEOUT))
+            return true;
+    return false;
+}
+
+static void setBaudRate(HardwareSerial &serial, const uint32_t baudRate) {
+    serial.flush();
+    serial.begin(baudRate);
+    // Drop anything received at the old rate
+    while (serial.available() > 0) serial.read();
+}
+
+// Looks for the STM32 at every rate, returning the index of the rate it is at
+// or -1 if it can't be found.
+static int8_t findBaudRate(HardwareSerial &serial, PacketSerial &packetSerial,
+                           const uint32_t timeout) {
+    const auto startTime = millis();
+    do {
+        for (uint8_t i = 0; i < LINK_BAUD_RATES.size(); ++i) {
+            setBaudRate(serial, LINK_BAUD_RATES[i]);
+            if (sendCommand(packetSerial, LINK_TEST_PING)) return i;
+        }
+    } while (millis() - startTime < timeout);
+    return -1;
+}
+
+// Has patterns of alternating, all-zero and all-one bits echoed back, and
+// returns how many were lost or corrupted.
+static uint16_t countPatternErrors(PacketSerial &packetSerial) {
+    uint16_t errors = 0;
+    LinkTestPayload payload;
+    payload.command = LINK_TEST_PATTERN;
+    for (uint16_t i = 0; i < LINK_TEST_FRAMES; ++i) {
+        payload.sequence = i;
+        for (uint8_t j = 0; j < LINK_TEST_PATTERN_SIZE; ++j) {
+            const uint8_t patterns[] = {0x55, 0xAA, 0x00, 0xFF};
+            payload.pattern[j] = patterns[(i + j) % 4];
+        }
+        if (!exchange(packetSerial, payload, LINK_TEST_PATTERN_TIMEOUT))
+            ++errors;
+    }
+    return errors;
+}
+
+uint32_t negotiateBaudRate(HardwareSerial &serial, LinkTestResults &results,
+                           const bool testAll, const uint32_t connectTimeout) {
+    results = LinkTestResults();
+    PacketSerial packetSerial;
+    packetSerial.setStream(&serial);
+    packetSerial.setPacketHandler(onReply);
+
+    // The STM32 may not have restarted along with us (or may have restarted
+    // without us), so look for it first
+    auto current = findBaudRate(serial, packetSerial, connectTimeout);
+    if (current < 0) {
+        // Nothing answered, so stay at the rate everything starts at
+        setBaudRate(serial, LINK_BAUD_RATES[0]);
+        return 0;
+    }
+
+    for (uint8_t next = current + 1; next < LINK_BAUD_RATES.size(); ++next) {
+        // Both switch to the next rate and test it
+        const auto baudRate = LINK_BAUD_RATES[next];
+        if (!sendCommand(packetSerial, LINK_TEST_SWITCH, baudRate)) break;
+        setBaudRate(serial, baudRate);
+        auto &result = results[next];
+        result.tested = true;
+        result.errors = countPatternErrors(packetSerial);
+        result.passed = result.errors <= LINK_TEST_MAX_ERRORS &&
+                        sendCommand(packetSerial, LINK_TEST_COMMIT);
+        if (result.passed) {
+            current = next;
+            continue;
+        }
+
+        // Go back to the last committed rate, giving the STM32 time to notice
+        // and do the same
+        setBaudRate(serial, LINK_BAUD_RATES[current]);
+        delay(LINK_TEST_FALLBACK_TIMEOUT * 2);
+        if (!testAll) break;
+    }
+
+    // If a commit got through but its echo didn't, the STM32 is at a rate we
+    // think failed, so look for it again
+    if (!sendCommand(packetSerial, LINK_TEST_END)) {
+        current = findBaudRate(serial, packetSerial, 0);
+        if (current < 0) current = 0;
+        setBaudRate(serial, LINK_BAUD_RATES[current]);
+        sendCommand(packetSerial, LINK_TEST_END);
+    }
+    return LINK_BAUD_RATES[current];
+}
+
+// Prints the frame error rate at each rate tested.
+void printLinkTestResults(const char *name, const LinkTestResults &results,
+                          Stream &serial) {
+    for (uint8_t i = 0; i < LINK_BAUD_RATES.size(); ++i) {
+        if (!results[i].tested) continue;
+        serial.printf("[%-5s] %7u baud: %3u/%u frames lost (%s)\n", name,
+                      LINK_BAUD_RATES[i], results[i].errors, LINK_TEST_FRAMES,
+                      results[i].passed ? "passed" : "failed");
+    }
+}
+
+// ---------------------------------- STM32 -----------------------------------
+
+static bool responding = false;
+static bool ended = false;
+static uint32_t baudRate = LINK_BAUD_RATES[0];
+static uint32_t committedBaudRate = LINK_BAUD_RATES[0];
+static uint32_t lastFrameTime = 0;
+
+bool respondToLinkTest(const uint8_t *frame, const size_t size,
+                       HardwareSerial &serial, PacketSerial &packetSerial) {
+    const uint8_t *payloadBuffer;
+    size_t payloadSize;
+    LinkTestPayload payload;
+    if (!decodeFrame(frame, size, PAYLOAD_LINK_TEST, payloadBuffer,
+                     payloadSize) ||
+        payloadSize != sizeof(payload))
+        return false;
+    memcpy(&payload, payloadBuffer, sizeof(payload));
+    lastFrameTime = millis();
+    if (!responding) ended = false;
+
+    // Echo everything back, at the old rate if switching
+    sendFrame(packetSerial, PAYLOAD_LINK_TEST, payload);
+    switch (payload.command) {
+    case LINK_TEST_SWITCH:
+        serial.flush();
+        baudRate = payload.baudRate;
+        serial.begin(baudRate);
+        break;
+    case LINK_TEST_COMMIT:
+        committedBaudRate = baudRate;
+        break;
+    case LINK_TEST_END:
+        ended = true;
+        break;
+    }
+
+    // Nested calls from packetSerial.update() below only answer
+    if (responding) return true;
+
+    // Answer nothing but link tests until the test is over
+    responding = true;
+    while (!ended) {
+        packetSerial.update();
+        const auto silence = millis() - lastFrameTime;
+        if (baudRate != committedBaudRate &&
+            silence > LINK_TEST_FALLBACK_TIMEOUT) {
+            // The Teensy gave up on the new rate
+            baudRate = committedBaudRate;
+            serial.begin(baudRate);
+            lastFrameTime = millis();
+        } else if (silence > LINK_TEST_END_TIMEOUT) {
+            break;
+        }
+    }
+    responding = false;
+    return true;
+}
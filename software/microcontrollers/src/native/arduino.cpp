@@ -0,0 +1,92 @@
+#include <Arduino.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+
+// Time
+static const auto _startTime = std::chrono::steady_clock::now();
+static bool _clockSet = false;
+static uint32_t _setMicros = 0;
+
+uint32_t millis() {
+    if (_clockSet) return _setMicros / 1000;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - _startTime)
+        .count();
+}
+
+uint32_t micros() {
+    if (_clockSet) return _setMicros;
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - _startTime)
+        .count();
+}
+
+void nativeSetMicros(uint32_t us) {
+    _clockSet = true;
+    _setMicros = us;
+}
+
+uint32_t nativeCycleCount() {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - _startTime)
+                        .count();
+    return (uint64_t)ns * (F_CPU_ACTUAL / 1000000) / 1000;
+}
+
+void delay(uint32_t ms) {}
+
+void delayMicroseconds(uint32_t us) {}
+
+// Pins
+static std::array<uint8_t, NATIVE_PIN_COUNT> _digitalValues = {};
+static std::array<int, NATIVE_PIN_COUNT> _analogReadValues = {};
+static std::array<int, NATIVE_PIN_COUNT> _analogWriteValues = {};
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < NATIVE_PIN_COUNT) _digitalValues[pin] = value;
+}
+
+uint8_t digitalRead(uint8_t pin) {
+    return pin < NATIVE_PIN_COUNT ? _digitalValues[pin] : LOW;
+}
+
+void analogReadResolution(unsigned int bits) {}
+
+void analogReadAveraging(unsigned int num) {}
+
+int analogRead(uint8_t pin) {
+    return pin < NATIVE_PIN_COUNT ? _analogReadValues[pin] : 0;
+}
+
+void analogWriteResolution(unsigned int bits) {}
+
+void analogWriteFrequency(uint8_t pin, float frequency) {}
+
+void analogWrite(uint8_t pin, int value) {
+    if (pin < NATIVE_PIN_COUNT) _analogWriteValues[pin] = value;
+}
+
+void nativeSetAnalogValue(uint8_t pin, int value) {
+    if (pin < NATIVE_PIN_COUNT) _analogReadValues[pin] = value;
+}
+
+int nativeAnalogWriteValue(uint8_t pin) {
+    return pin < NATIVE_PIN_COUNT ? _analogWriteValues[pin] : 0;
+}
+
+// Serial
+size_t HardwareSerial::write(uint8_t byte) {
+    ++_txCount;
+    if (_echo) putchar(byte);
+    return 1;
+}
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial Serial2;
+HardwareSerial Serial3;
+HardwareSerial Serial4;
@@ -0,0 +1,39 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+float BenchStats::mean() const {
+    if (_samples.empty()) return NAN;
+    const auto sum = std::accumulate(_samples.begin(), _samples.end(), 0.0);
+    return sum / _samples.size() / 1000;
+}
+
+float BenchStats::min() const {
+    if (_samples.empty()) return NAN;
+    return *std::min_element(_samples.begin(), _samples.end()) / 1000.0F;
+}
+
+float BenchStats::max() const {
+    if (_samples.empty()) return NAN;
+    return *std::max_element(_samples.begin(), _samples.end()) / 1000.0F;
+}
+
+// Nearest-rank percentile, p from 0 to 100.
+float BenchStats::percentile(float p) const {
+    if (_samples.empty()) return NAN;
+    auto sorted = _samples;
+    const auto rank = std::min(
+        (size_t)std::ceil(p / 100 * sorted.size()), sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank] / 1000.0F;
+}
+
+void BenchStats::print(const char *suite, const char *name) const {
+    printf("[%s] %-24s mean=%8.3f (p50=%8.3f, p99=%8.3f, min=%8.3f, "
+           "max=%9.3f) µs, samples=%zu\n",
+           suite, name, mean(), percentile(50), percentile(99), min(), max(),
+           count());
+}
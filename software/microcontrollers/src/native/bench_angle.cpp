@@ -0,0 +1,94 @@
+#include <cmath>
+#include <cstdio>
+
+#include "angle.h"
+#include "bench.h"
+
+// fromDegrees() is usable in constant expressions, such as tables of bearings
+static_assert(BinaryAngle::fromDegrees(90).raw() == 0x4000, "90º");
+static_assert(BinaryAngle::fromDegrees(-90 + 3600).raw() == 0xC000, "-90º");
+static_assert(BinaryAngle::fromDegrees(1e30F) ==
+                  BinaryAngle::fromDegrees(__builtin_fmodf(1e30F, 360)),
+              "huge degrees");
+static_assert(BinaryAngle::fromDegrees(__builtin_nanf("")).raw() == 0, "NaN");
+
+// Counts a failed check, printing the first few.
+#define BENCH_ANGLE_CHECK(condition, ...)                                      \
+    do {                                                                       \
+        if (!(condition) && ++failures <= 10) {                                \
+            printf("[angle] " __VA_ARGS__);                                    \
+            printf("\n");                                                      \
+        }                                                                      \
+    } while (0)
+
+// Checks BinaryAngle's conversions and wrap-around, and that it takes any
+// float, including ones without an angle.
+bool benchAngle() {
+    uint32_t failures = 0;
+
+    // Conversions
+    for (int32_t centidegrees = -17999; centidegrees <= 18000; ++centidegrees)
+        BENCH_ANGLE_CHECK(
+            BinaryAngle::fromCentidegrees(centidegrees).centidegrees() ==
+                centidegrees,
+            "%d centidegrees round-tripped to %d", centidegrees,
+            BinaryAngle::fromCentidegrees(centidegrees).centidegrees());
+    for (uint32_t raw = 0; raw <= UINT16_MAX; ++raw) {
+        const auto angle = BinaryAngle::fromRaw(raw);
+        BENCH_ANGLE_CHECK(BinaryAngle::fromDegrees(angle.degrees()) == angle,
+                          "%u round-tripped through degrees to %u", raw,
+                          BinaryAngle::fromDegrees(angle.degrees()).raw());
+        BENCH_ANGLE_CHECK(BinaryAngle::fromDegrees(angle.bearing()) == angle,
+                          "%u round-tripped through its bearing to %u", raw,
+                          BinaryAngle::fromDegrees(angle.bearing()).raw());
+    }
+    BENCH_ANGLE_CHECK(BinaryAngle::fromRaw(0x8000).degrees() == 180.0F &&
+                          BinaryAngle::fromRaw(0x8000).centidegrees() == 18000,
+                      "0x8000 isn't +180º");
+    BENCH_ANGLE_CHECK(BinaryAngle::fromDegrees(-180) ==
+                          BinaryAngle::fromRaw(0x8000),
+                      "-180º isn't 0x8000");
+
+    // Wrap-around, in whole and quarter degrees so that adding turns is exact
+    for (float degrees = -720; degrees <= 720; degrees += 0.25F)
+        for (int32_t turns = -3; turns <= 3; ++turns)
+            BENCH_ANGLE_CHECK(
+                BinaryAngle::fromDegrees(degrees + 360.0F * turns) ==
+                    BinaryAngle::fromDegrees(degrees),
+                "%.2fº + %d turns is %u, not %u", degrees, turns,
+                BinaryAngle::fromDegrees(degrees + 360.0F * turns).raw(),
+                BinaryAngle::fromDegrees(degrees).raw());
+    // Angles that are whole units, so that sums are exact
+    const auto a = BinaryAngle::fromDegrees(90);
+    const auto b = BinaryAngle::fromDegrees(135);
+    BENCH_ANGLE_CHECK(a + b == BinaryAngle::fromDegrees(-135),
+                      "90º + 135º is %.2fº", (a + b).degrees());
+    BENCH_ANGLE_CHECK(-a - b == BinaryAngle::fromDegrees(135),
+                      "-90º - 135º is %.2fº", (-a - b).degrees());
+    BENCH_ANGLE_CHECK((a - b).abs() == BinaryAngle::fromDegrees(45),
+                      "|90º - 135º| is %.2fº", (a - b).abs().degrees());
+    BENCH_ANGLE_CHECK(BinaryAngle::fromDegrees(10) <
+                          BinaryAngle::fromDegrees(-10),
+                      "10º doesn't come before -10º (350º)");
+
+    // Floats without an angle, or large enough to need reducing exactly
+    volatile float nonFinite[] = {NAN, INFINITY, -INFINITY};
+    for (const float degrees : nonFinite) {
+        BENCH_ANGLE_CHECK(BinaryAngle::fromDegrees(degrees).raw() == 0,
+                          "non-finite degrees gave %u",
+                          BinaryAngle::fromDegrees(degrees).raw());
+    }
+    volatile float huge[] = {1e10F, -3e20F, 1e30F, 3.4e38F};
+    for (const float degrees : huge) {
+        const auto reduced = fmod((double)degrees, 360);
+        BENCH_ANGLE_CHECK(BinaryAngle::fromDegrees(degrees) ==
+                              BinaryAngle::fromDegrees(reduced),
+                          "%gº gave %u, not %u", degrees,
+                          BinaryAngle::fromDegrees(degrees).raw(),
+                          BinaryAngle::fromDegrees(reduced).raw());
+    }
+
+    printf("[angle] BinaryAngle %s (%u failures)\n",
+           failures == 0 ? "passed" : "failed", failures);
+    return failures == 0;
+}
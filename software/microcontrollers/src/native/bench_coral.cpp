@@ -0,0 +1,122 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "bench.h"
+#include "payloads.h"
+
+#define BENCH_CORAL_BATCH_SIZE 1000
+
+// Prints a failed check and returns whether it passed.
+static bool check(bool passed, const char *what, float input, int32_t actual,
+                  int32_t expected) {
+    if (!passed)
+        printf("[coral] %s(%g) = %d, expected %d\n", what, input, actual,
+               expected);
+    return passed;
+}
+
+// The centidegree a wire angle should have, wrapped to -179(.)99º to 180(.)00º.
+static int32_t expectedCentidegrees(double degrees) {
+    auto wrapped = fmod(degrees, 360);
+    wrapped = wrapped <= -180 ? wrapped + 360
+              : wrapped > 180 ? wrapped - 360
+                              : wrapped;
+    return lround(wrapped * 100);
+}
+
+// Checks that CoralRXPayload encodes what the Coral expects (angles wrapped to
+// within a centidegree, rates clamped to their range, the layout unpacked by
+// payloads.py) and times it.
+bool benchCoral() {
+    bool passed = true;
+
+    // Heading isn't sent until it's set
+    CoralRXPayload payload;
+    passed &= check(payload.heading == NO_ANGLE, "heading", NAN,
+                    payload.heading, NO_ANGLE);
+
+    // Angles, including ones that need wrapping and both ends of the range
+    const float angles[] = {0,   0.004F,  0.005F,   12.34F, -12.34F, 90,
+                            180, 179.99F, -179.99F, -180,   359.5F,  -725.25F};
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<float> randomAngles(-720.0F, 720.0F);
+    for (uint32_t i = 0; i < 100000 + sizeof(angles) / sizeof(angles[0]);
+         ++i) {
+        const auto angle = i < sizeof(angles) / sizeof(angles[0])
+                               ? angles[i]
+                               : randomAngles(rng);
+        payload.setHeading(angle, 0);
+        payload.setMovement(angle, 0);
+        const auto expected = expectedCentidegrees(angle);
+        // The BAM rounding in between can be off by one, and ±180º are the
+        // same angle
+        const auto near = [&](int16_t actual) {
+            const auto error = abs(actual - expected) % 36000;
+            return error <= 1 || error >= 35999;
+        };
+        passed &= check(near(payload.heading) && payload.heading > -18000 &&
+                            payload.heading <= 18000,
+                        "heading", angle, payload.heading, expected);
+        passed &= check(near(payload.movementAngle), "movementAngle", angle,
+                        payload.movementAngle, expected);
+    }
+
+    // Rates are in tenths of a degree per second and saturate
+    const struct {
+        float rate;
+        int16_t expected;
+    } rates[] = {{0, 0},
+                 {12.34F, 123},
+                 {-12.36F, -124},
+                 {3276.7F, 32767},
+                 {5000, INT16_MAX},
+                 {-5000, INT16_MIN},
+                 {1.0e9F, INT16_MAX},
+                 {-1.0e9F, INT16_MIN}};
+    for (const auto &rate : rates) {
+        payload.setHeading(0, rate.rate);
+        passed &= check(payload.headingRate == rate.expected, "headingRate",
+                        rate.rate, payload.headingRate, rate.expected);
+    }
+
+    // Velocities go through untouched
+    for (const int16_t velocity : {0, 35, -35, 1023, -1023}) {
+        payload.setMovement(0, velocity);
+        passed &= check(payload.movementVelocity == velocity,
+                        "movementVelocity", velocity, payload.movementVelocity,
+                        velocity);
+    }
+
+    // Layout, as unpacked with CoralRXPayload.FORMAT = "<hhhh"
+    payload.setHeading(-90, -12.5F);
+    payload.setMovement(45, 600);
+    const uint8_t expectedBytes[] = {0xD8, 0xDC, 0x83, 0xFF,
+                                     0x94, 0x11, 0x58, 0x02};
+    uint8_t bytes[sizeof(payload)];
+    memcpy(bytes, &payload, sizeof(payload));
+    const auto layoutMatches =
+        sizeof(bytes) == sizeof(expectedBytes) &&
+        memcmp(bytes, expectedBytes, sizeof(bytes)) == 0;
+    if (!layoutMatches) printf("[coral] layout differs from payloads.py\n");
+    passed &= layoutMatches;
+
+    // Throughput
+    BenchStats stats(BENCH_CORAL_ITERATIONS);
+    for (uint32_t i = 0; i < BENCH_CORAL_ITERATIONS; ++i) {
+        stats.add(benchTime([&] {
+            for (uint32_t j = 0; j < BENCH_CORAL_BATCH_SIZE; ++j) {
+                CoralRXPayload encoded;
+                encoded.setHeading(angles[j % 12], angles[(j + 1) % 12]);
+                encoded.setMovement(angles[(j + 2) % 12], j);
+                benchKeep(encoded);
+            }
+        }) / BENCH_CORAL_BATCH_SIZE);
+    }
+    stats.print("coral", "CoralRXPayload");
+    printf("[coral] encoder %s\n", passed ? "passed" : "failed");
+
+    return passed;
+}
@@ -0,0 +1,130 @@
+#include <array>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "filter_score.h"
+#include "ldr_filter.h"
+
+#define BENCH_FILTER_LDR_COUNT 30
+#define BENCH_FILTER_LDR_MASK  ((1UL << BENCH_FILTER_LDR_COUNT) - 1)
+
+// LDRFilter one LDR at a time, counting hits in a window as it says it does.
+class ScalarLDRFilter {
+  public:
+    ScalarLDRFilter(const LDRFilterCandidate &candidate)
+        : _candidate(candidate) {}
+
+    uint32_t update(const uint32_t hits) {
+        uint32_t state = 0;
+        for (uint8_t i = 0; i < BENCH_FILTER_LDR_COUNT; ++i) {
+            auto &window = _windows[i];
+            window.push_back(hits >> i & 1);
+            if (window.size() > _candidate.window) window.pop_front();
+            uint8_t count = 0;
+            for (const auto hit : window) count += hit;
+
+            if (count >= _candidate.onThreshold)
+                _on[i] = true;
+            else if (_candidate.policy == LDR_FILTER_K_OF_N ||
+                     count <= _candidate.offThreshold)
+                _on[i] = false;
+            if (_on[i]) state |= 1UL << i;
+        }
+        return state;
+    }
+
+  private:
+    LDRFilterCandidate _candidate;
+    std::array<std::deque<bool>, BENCH_FILTER_LDR_COUNT> _windows;
+    std::array<bool, BENCH_FILTER_LDR_COUNT> _on = {};
+};
+
+// Returns hits like the LDRs' as the line passes under the robot, with noise:
+// a band of LDRs is on the line for a while every so often, each of which is
+// sometimes missed, and the others are sometimes hit.
+static std::vector<uint32_t> syntheticTrace(std::mt19937 &rng) {
+    std::uniform_int_distribution<uint32_t> ldr(0, BENCH_FILTER_LDR_COUNT - 1);
+    std::uniform_int_distribution<uint32_t> width(1, 8);
+    std::uniform_int_distribution<uint32_t> duration(5, 200); // in scans
+    std::bernoulli_distribution miss(BENCH_FILTER_MISS_PROBABILITY);
+    std::bernoulli_distribution falseHit(BENCH_FILTER_FALSE_HIT_PROBABILITY);
+
+    std::vector<uint32_t> trace;
+    trace.reserve(BENCH_FILTER_SCANS);
+    while (trace.size() < BENCH_FILTER_SCANS) {
+        // On the field for a while, then on the line
+        uint32_t line = 0;
+        const auto first = ldr(rng), count = width(rng);
+        for (uint32_t i = 0; i < count; ++i)
+            line |= 1UL << (first + i) % BENCH_FILTER_LDR_COUNT;
+        for (const auto onLine : {0U, line}) {
+            for (auto scans = duration(rng); scans > 0; --scans) {
+                uint32_t hits = 0;
+                for (uint8_t i = 0; i < BENCH_FILTER_LDR_COUNT; ++i)
+                    if (onLine >> i & 1 ? !miss(rng) : falseHit(rng))
+                        hits |= 1UL << i;
+                trace.push_back(hits);
+            }
+        }
+    }
+    return trace;
+}
+
+// Checks that the bit-sliced LDRFilter matches a filter on each LDR for every
+// candidate and every valid policy, on random hits. Then times it and scores
+// the candidates on a synthetic trace.
+bool benchFilter() {
+    std::vector<LDRFilterCandidate> policies = LDR_FILTER_CANDIDATES;
+    for (uint8_t window = 1; window <= LDR_FILTER_MAX_WINDOW; ++window)
+        for (uint8_t on = 1; on <= window; ++on)
+            for (uint8_t off = 0; off < on; ++off)
+                for (const uint8_t policy :
+                     {LDR_FILTER_K_OF_N, LDR_FILTER_HYSTERESIS})
+                    if (policy == LDR_FILTER_HYSTERESIS || off == 0)
+                        policies.push_back({"", policy, window, on, off});
+
+    bool passed = true;
+    std::mt19937 rng(2023);
+    uint32_t mismatches = 0;
+    for (const auto &policy : policies) {
+        LDRFilter filter;
+        filter.configure(policy.policy, policy.window, policy.onThreshold,
+                         policy.offThreshold);
+        ScalarLDRFilter expectedFilter(policy);
+        // Bias the hits towards runs of them, so that the LDRs turn on and off
+        uint32_t hits = 0;
+        for (uint32_t scan = 0; scan < BENCH_FILTER_CHECK_SCANS; ++scan) {
+            hits ^= rng() & rng() & rng() & BENCH_FILTER_LDR_MASK;
+            const auto state = filter.update(hits);
+            const auto expected = expectedFilter.update(hits);
+            if (state == expected) continue;
+            if (++mismatches <= 10)
+                printf("[filter] policy %u, %u of %u (off at %u), scan %u: "
+                       "0x%08x, expected 0x%08x\n",
+                       policy.policy, policy.onThreshold, policy.window,
+                       policy.offThreshold, scan, state, expected);
+            passed = false;
+            break;
+        }
+    }
+    printf("[filter] %zu policies checked over %u scans\n", policies.size(),
+           BENCH_FILTER_CHECK_SCANS);
+
+    // Throughput, with the window of the default policy
+    LDRFilter filter;
+    filter.configure(LDR_FILTER_K_OF_N, 3, 2);
+    BenchStats stats(BENCH_FILTER_ITERATIONS);
+    for (uint32_t i = 0; i < BENCH_FILTER_ITERATIONS; ++i) {
+        const auto hits = rng();
+        stats.add(benchTime([&] { benchKeep(filter.update(hits)); }));
+    }
+    stats.print("filter", "LDRFilter::update (2 of 3)");
+
+    scoreLDRFilters(syntheticTrace(rng), "filter");
+    printf("[filter] LDR filter %s\n", passed ? "passed" : "failed");
+
+    return passed;
+}
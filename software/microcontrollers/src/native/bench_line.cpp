@@ -0,0 +1,136 @@
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "bench.h"
+#include "line_cluster.h"
+
+#define BENCH_LINE_LDR_COUNT 30
+
+// From src/stm32_mux/include/config.h
+const std::array<float, BENCH_LINE_LDR_COUNT> BENCH_LINE_BEARINGS = {
+    8.1461,   26.9079,  39.7366,  51.1272,  61.88670, 73.1367,
+    84.3867,  95.6367,  106.8867, 118.1367, 129.1957, 141.0268,
+    152.4409, 162.7907, 174.2699, 185.7539, 197.2331, 208.3438,
+    219.6814, 231.0705, 241.8867, 253.1367, 264.3867, 275.6367,
+    286.8867, 298.1367, 309.2879, 320.4649, 333.8737, 351.8859,
+};
+
+// The O(n²) search findLine() used before findLineCluster().
+static bool findLineClusterPairwise(const float *bearings,
+                                    const uint8_t *matches,
+                                    const uint8_t matchCount, uint8_t &start,
+                                    uint8_t &end) {
+    float maxAngleDifference = 0;
+    bool found = false;
+    for (uint8_t i = 0; i + 1 < matchCount; ++i) {
+        for (uint8_t j = i + 1; j < matchCount; ++j) {
+            auto angleDifference =
+                fabsf(bearings[matches[i]] - bearings[matches[j]]);
+            angleDifference =
+                angleDifference > 180 ? 360 - angleDifference : angleDifference;
+            if (angleDifference > maxAngleDifference) {
+                maxAngleDifference = angleDifference;
+                start = matches[i];
+                end = matches[j];
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+// Checks findLineCluster() against findLineClusterPairwise() on a pattern,
+// printing the first few mismatches.
+static bool check(const float *bearings, const uint8_t *matches,
+                  const uint8_t matchCount) {
+    static uint32_t mismatches = 0;
+    uint8_t start = 0, end = 0, expectedStart = 0, expectedEnd = 0;
+    const auto found =
+        findLineCluster(bearings, matches, matchCount, start, end);
+    const auto expectedFound = findLineClusterPairwise(
+        bearings, matches, matchCount, expectedStart, expectedEnd);
+    if (found == expectedFound &&
+        (!found || (start == expectedStart && end == expectedEnd)))
+        return true;
+
+    if (++mismatches <= 10) {
+        printf("[line] {");
+        for (uint8_t i = 0; i < matchCount; ++i) printf(" %u", matches[i]);
+        printf(" }: %d (%u, %u), expected %d (%u, %u)\n", found, start, end,
+               expectedFound, expectedStart, expectedEnd);
+    }
+    return false;
+}
+
+// Checks every pattern of up to maxActive of the LDRs from index on, given
+// the matches so far.
+static bool checkPatterns(const float *bearings, uint8_t *matches,
+                          const uint8_t matchCount, const uint8_t index,
+                          const uint8_t maxActive, uint32_t &count) {
+    bool passed = check(bearings, matches, matchCount);
+    ++count;
+    if (matchCount == maxActive) return passed;
+    for (uint8_t i = index; i < BENCH_LINE_LDR_COUNT; ++i) {
+        matches[matchCount] = i;
+        passed &= checkPatterns(bearings, matches, matchCount + 1, i + 1,
+                                maxActive, count);
+    }
+    return passed;
+}
+
+// Checks that findLineCluster() picks the same cluster ends as the pairwise
+// search it replaced, on every pattern of up to BENCH_LINE_MAX_ACTIVE active
+// LDRs and on random patterns of any size, for the robot's LDRs and for
+// evenly spaced ones (where many pairs tie). Then times both.
+bool benchLine() {
+    std::array<float, BENCH_LINE_LDR_COUNT> evenBearings;
+    for (uint8_t i = 0; i < BENCH_LINE_LDR_COUNT; ++i)
+        evenBearings[i] = i * 360.0F / BENCH_LINE_LDR_COUNT;
+
+    bool passed = true;
+    std::mt19937 rng(2023);
+    const struct {
+        const char *name;
+        const float *bearings;
+    } bearingSets[] = {{"robot's", BENCH_LINE_BEARINGS.data()},
+                       {"evenly spaced", evenBearings.data()}};
+    for (const auto &[name, bearings] : bearingSets) {
+        uint8_t matches[BENCH_LINE_LDR_COUNT];
+        uint32_t count = 0;
+        passed &= checkPatterns(bearings, matches, 0, 0, BENCH_LINE_MAX_ACTIVE,
+                                count);
+        for (uint32_t i = 0; i < BENCH_LINE_RANDOM_PATTERNS; ++i) {
+            const auto pattern = rng();
+            uint8_t matchCount = 0;
+            for (uint8_t j = 0; j < BENCH_LINE_LDR_COUNT; ++j)
+                if (pattern >> j & 1) matches[matchCount++] = j;
+            passed &= check(bearings, matches, matchCount);
+        }
+        printf("[line] %s LDRs: %u patterns of up to %u active and %u "
+               "random ones checked\n",
+               name, count, BENCH_LINE_MAX_ACTIVE, BENCH_LINE_RANDOM_PATTERNS);
+    }
+
+    // Throughput, with every LDR active (the worst case for both)
+    uint8_t matches[BENCH_LINE_LDR_COUNT];
+    for (uint8_t i = 0; i < BENCH_LINE_LDR_COUNT; ++i) matches[i] = i;
+    const auto time = [&](auto findCluster) {
+        BenchStats stats(BENCH_LINE_ITERATIONS);
+        for (uint32_t i = 0; i < BENCH_LINE_ITERATIONS; ++i) {
+            stats.add(benchTime([&] {
+                uint8_t start, end;
+                benchKeep(findCluster(BENCH_LINE_BEARINGS.data(), matches,
+                                      BENCH_LINE_LDR_COUNT, start, end));
+                benchKeep(start);
+            }));
+        }
+        return stats;
+    };
+    time(findLineCluster).print("line", "findLineCluster (30 active)");
+    time(findLineClusterPairwise).print("line", "pairwise (30 active)");
+    printf("[line] cluster detection %s\n", passed ? "passed" : "failed");
+
+    return passed;
+}
@@ -0,0 +1,191 @@
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+#include "bench.h"
+#include "line_cluster.h"
+#include "line_motion.h"
+
+#define BENCH_MOTION_LDR_COUNT   30
+#define BENCH_MOTION_SCAN_PERIOD 2787 // in µs, as the MUX's loop time
+// LDRs this close to either end of the line see it
+#define BENCH_MOTION_LINE_HALF_WIDTH 10.0F // in º
+
+// From src/stm32_mux/include/config.h
+const std::array<float, BENCH_MOTION_LDR_COUNT> BENCH_MOTION_BEARINGS = {
+    8.1461,   26.9079,  39.7366,  51.1272,  61.88670, 73.1367,
+    84.3867,  95.6367,  106.8867, 118.1367, 129.1957, 141.0268,
+    152.4409, 162.7907, 174.2699, 185.7539, 197.2331, 208.3438,
+    219.6814, 231.0705, 241.8867, 253.1367, 264.3867, 275.6367,
+    286.8867, 298.1367, 309.2879, 320.4649, 333.8737, 351.8859,
+};
+#define BENCH_MOTION_MIN_STEP         6.0F // LINE_RATE_MIN_STEP
+#define BENCH_MOTION_GAIN             0.5F // LINE_RATE_GAIN
+#define BENCH_MOTION_MIN_APPROACH     0.5F // LINE_MIN_APPROACH_RATE
+#define BENCH_MOTION_MAX_END_MOVE     90.0F // LINE_MAX_END_MOVE
+
+// Counts a failed check, printing the first few.
+#define BENCH_MOTION_CHECK(condition, ...)                                     \
+    do {                                                                       \
+        if (!(condition) && ++failures <= 10) {                                \
+            printf("[motion] " __VA_ARGS__);                                   \
+            printf("\n");                                                      \
+        }                                                                      \
+    } while (0)
+
+// Finds the line like findLine() does without analogLineEstimation, when its
+// ends are at centre ± span / 2 (in º), setting the ends it finds.
+static void scan(const float centre, const float span, LineData &line,
+                 BinaryAngle &start, BinaryAngle &end) {
+    uint8_t matches[BENCH_MOTION_LDR_COUNT];
+    uint8_t matchCount = 0;
+    for (uint8_t i = 0; i < BENCH_MOTION_LDR_COUNT; ++i) {
+        const auto offset = BENCH_MOTION_BEARINGS[i] - centre;
+        if (fabsf(clipAngle(offset - span / 2)) <=
+                BENCH_MOTION_LINE_HALF_WIDTH ||
+            fabsf(clipAngle(offset + span / 2)) <=
+                BENCH_MOTION_LINE_HALF_WIDTH)
+            matches[matchCount++] = i;
+    }
+
+    line = LineData();
+    uint8_t clusterStart, clusterEnd;
+    if (!findLineCluster(BENCH_MOTION_BEARINGS.data(), matches, matchCount,
+                         clusterStart, clusterEnd))
+        return;
+    start = BinaryAngle::fromDegrees(BENCH_MOTION_BEARINGS[clusterStart]);
+    end = BinaryAngle::fromDegrees(BENCH_MOTION_BEARINGS[clusterEnd]);
+    const auto difference = end - start;
+    line.angleBisector =
+        (start + BinaryAngle::fromRaw(difference.raw() / 2)).centidegrees();
+    line.confidence = 100;
+    line.size = (difference.abs().raw() * 100 + 16384) / 32768;
+}
+
+// Scans a line around centre whose span (in º) goes from one to another at
+// sizeRate (in size/s) while it turns at angleRate (in º/s), updating motion
+// with each scan and then calling check with the line, its actual span (folded
+// to at most 180º) and whether it has moved far enough for both of its ends
+// to have been rated.
+template <class Check>
+static void run(LineMotion &motion, const float centre, const float fromSpan,
+                const float toSpan, const float sizeRate, const float angleRate,
+                Check &&check) {
+    motion.reset();
+    const auto direction = toSpan > fromSpan ? 1 : -1;
+    const auto duration = (toSpan - fromSpan) * direction / 180 / sizeRate;
+    for (uint32_t time = 0; time * 1e-6F <= duration;
+         time += BENCH_MOTION_SCAN_PERIOD) {
+        const auto t = time * 1e-6F;
+        const auto span = fromSpan + sizeRate * 180 * t * direction;
+        LineData line;
+        BinaryAngle start, end;
+        scan(centre + angleRate * t, span, line, start, end);
+        motion.update(line, start, end, time);
+        check(line, span > 180 ? 360 - span : span,
+              fabsf(span - fromSpan) >= BENCH_MOTION_SETTLE_SPAN);
+    }
+}
+
+// Checks LineMotion on lines found from the LDRs (so they move in steps) around
+// every bearing: approaching and retreating, crossing the middle (where the
+// bisector flips), the time to cross saturating, and slow approaches (one LDR
+// at a time) never looking fast enough to be crossing.
+bool benchLineMotion() {
+    uint32_t failures = 0;
+    LineMotion motion({BENCH_MOTION_MIN_STEP, BENCH_MOTION_GAIN,
+                       BENCH_MOTION_MIN_APPROACH,
+                       BENCH_MOTION_MAX_END_MOVE});
+    float worstTimeError = 0, worstAngleError = 0, worstSlowRate = 0;
+    uint32_t flips = 0;
+
+    for (float centre = 0; centre < 360; centre += 5) {
+        // Approaching at 2 size/s, the time to cross follows the actual one
+        // once a few moves have been seen
+        float timeError = 0;
+        run(motion, centre, 20, 150, 2, 0,
+            [&](const LineData &line, const float span, const bool settled) {
+                if (!settled) return;
+                const auto expected = (1 - span / 180) / 2 * 1000;
+                timeError = line.timeToCross == NO_CROSSING
+                                ? INFINITY
+                                : fmaxf(timeError, fabsf(line.timeToCross -
+                                                         expected));
+            });
+        BENCH_MOTION_CHECK(timeError <= BENCH_MOTION_MAX_TIME_ERROR,
+                           "approach around %.0fº: time to cross off by "
+                           "%.0f ms",
+                           centre, timeError);
+        worstTimeError = fmaxf(worstTimeError, timeError);
+
+        // Retreating at 1 size/s, it is never crossing
+        bool crossing = false;
+        float minRate = 0;
+        run(motion, centre, 170, 20, 1, 0,
+            [&](const LineData &line, const float, const bool) {
+                crossing |= line.timeToCross != NO_CROSSING;
+                minRate = fminf(minRate, motion.sizeRate());
+            });
+        BENCH_MOTION_CHECK(!crossing && minRate <= -BENCH_MOTION_MIN_APPROACH,
+                           "retreat around %.0fº: %s, at most %.2f size/s",
+                           centre, crossing ? "crossing" : "not crossing",
+                           minRate);
+
+        // Crossing the middle while turning at 30º/s, the bisector may flip
+        // but its rate stays near the robot's turning
+        float angleError = 0;
+        auto lastBisector = BinaryAngle::fromDegrees(centre);
+        run(motion, centre, 60, 300, 1, 30,
+            [&](const LineData &line, const float, const bool settled) {
+                const auto bisector =
+                    BinaryAngle::fromCentidegrees(line.angleBisector);
+                if ((bisector - lastBisector).abs().degrees() > 90) ++flips;
+                lastBisector = bisector;
+                if (!settled) return;
+                angleError = fmaxf(angleError, fabsf(motion.angleRate() - 30));
+            });
+        BENCH_MOTION_CHECK(angleError <= BENCH_MOTION_MAX_ANGLE_RATE_ERROR,
+                           "crossing around %.0fº: bisector rate off by "
+                           "%.0fº/s",
+                           centre, angleError);
+        worstAngleError = fmaxf(worstAngleError, angleError);
+
+        // Half as fast as LINE_MIN_APPROACH_RATE, one LDR at a time
+        float maxRate = 0;
+        crossing = false;
+        run(motion, centre, 20, 170, BENCH_MOTION_MIN_APPROACH / 2, 0,
+            [&](const LineData &line, const float, const bool) {
+                crossing |= line.timeToCross != NO_CROSSING;
+                maxRate = fmaxf(maxRate, motion.sizeRate());
+            });
+        BENCH_MOTION_CHECK(!crossing && maxRate <= BENCH_MOTION_MIN_APPROACH,
+                           "slow approach around %.0fº: %s, up to %.2f size/s",
+                           centre, crossing ? "crossing" : "not crossing",
+                           maxRate);
+        worstSlowRate = fmaxf(worstSlowRate, maxRate);
+    }
+
+    // Approaching so slowly that it would take longer than NO_CROSSING to
+    // cross, it saturates rather than wrapping around
+    LineMotion slowMotion({BENCH_MOTION_MIN_STEP, BENCH_MOTION_GAIN, 0.001F,
+                           BENCH_MOTION_MAX_END_MOVE});
+    bool saturated = true;
+    run(slowMotion, 90, 20, 60, 0.005F, 0,
+        [&](const LineData &line, const float, const bool) {
+            saturated &= line.timeToCross == NO_CROSSING;
+        });
+    BENCH_MOTION_CHECK(saturated && slowMotion.sizeRate() > 0.001F,
+                       "slow approach: %s at %.4f size/s",
+                       saturated ? "saturated" : "didn't saturate",
+                       slowMotion.sizeRate());
+
+    // Or the crossings haven't checked the flip
+    BENCH_MOTION_CHECK(flips > 0, "the bisector never flipped");
+
+    printf("[motion] worst time to cross error %.0f ms, bisector rate error "
+           "%.0fº/s, slow approach rate %.2f size/s (%u flips)\n",
+           worstTimeError, worstAngleError, worstSlowRate, flips);
+    printf("[motion] line motion %s (%u failures)\n",
+           failures == 0 ? "passed" : "failed", failures);
+    return failures == 0;
+}
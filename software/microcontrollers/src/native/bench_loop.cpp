@@ -0,0 +1,183 @@
+#include <Arduino.h>
+#include <PacketSerial.h>
+#include <cstdio>
+#include <random>
+
+#include "bench.h"
+#include "framing.h"
+#include "profiler.h"
+#include "shared_config.h"
+#include "teensy/include/config.h"
+#include "teensy/include/main.h"
+
+// Packet periods in Teensy loops, from the loop times in shared_config.h
+#define MUX_PACKET_PERIOD   11  // 2787 µs / 260 µs
+#define IMU_PACKET_PERIOD   5   // 1262 µs / 260 µs
+#define TOF_PACKET_PERIOD   119 // 30972 µs / 260 µs
+#define CORAL_PACKET_PERIOD 128 // ~30 FPS / 260 µs
+
+#define LIGHTGATE_WITH_BALL    (LIGHTGATE_CAPTURE_THRESHOLD / 2)
+#define LIGHTGATE_WITHOUT_BALL (LIGHTGATE_LOSS_THRESHOLD * 2)
+
+// Describes the synthetic world the robot sees during a run.
+struct Scenario {
+    const char *name;
+    bool masterIsStriker;
+    bool hasBall;
+    bool seesBall;
+    bool seesGoals;
+    bool onLine;
+    uint8_t packetPeriodScaler; // 0 to send every packet on every loop
+};
+
+const Scenario SCENARIOS[] = {
+    {"idle", true, false, false, false, false, 1},
+    {"striker (chase ball)", true, false, true, true, false, 1},
+    {"striker (attack goal)", true, true, true, true, false, 1},
+    {"striker (on line)", true, false, true, true, true, 1},
+    {"goalie", false, false, true, true, true, 1},
+    {"worst case (burst)", true, false, true, true, true, 0},
+};
+
+// Stamps a payload with the next header of its link, frames it and COBS-encodes
+// it onto the RX side of a serial port.
+template <class Payload>
+void injectPacket(HardwareSerial &serial, const uint8_t type,
+                  Payload payload) {
+    static PacketHeader header;
+    header.advance(micros());
+    payload.header = header;
+
+    byte buf[sizeof(Payload) + FRAME_OVERHEAD];
+    const auto frameSize =
+        encodeFrame(type, (const byte *)&payload, sizeof(payload), buf);
+    byte encoded[sizeof(buf) + sizeof(buf) / 254 + 2];
+    const auto size = COBS::encode(buf, frameSize, encoded);
+    encoded[size] = 0;
+    serial.inject(encoded, size + 1);
+}
+
+// Generates the packets of one scenario for a given loop iteration.
+class PacketGenerator {
+  public:
+    PacketGenerator(const Scenario &scenario) : _scenario(scenario) {}
+
+    void inject(uint32_t iteration) {
+        const auto due = [&](uint32_t period) {
+            const auto scaled = period * _scenario.packetPeriodScaler;
+            return scaled == 0 || iteration % scaled == 0;
+        };
+        if (due(MUX_PACKET_PERIOD))
+            injectPacket(MUX_SERIAL, PAYLOAD_MUX_TX, mux());
+        if (due(IMU_PACKET_PERIOD))
+            injectPacket(IMU_SERIAL, PAYLOAD_IMU_TX, imu());
+        if (due(TOF_PACKET_PERIOD))
+            injectPacket(TOF_SERIAL, PAYLOAD_TOF_TX, tof());
+        if (due(CORAL_PACKET_PERIOD))
+            injectPacket(CORAL_SERIAL, PAYLOAD_CORAL_TX, coral());
+        nativeSetAnalogValue(PIN_LIGHTGATE, _scenario.hasBall
+                                                ? LIGHTGATE_WITH_BALL
+                                                : LIGHTGATE_WITHOUT_BALL);
+        // There are no interrupts here, so sample it once per loop instead
+        sampleLightgate();
+    }
+
+    MUXTXPayload mux() {
+        MUXTXPayload payload;
+        if (_scenario.onLine) {
+            // Drift along the line with the occasional jump across it
+            _lineAngle += noise(200);
+            if (uniform(0, 99) == 0) _lineAngle += 18000;
+            _lineAngle = wrap(_lineAngle);
+            payload.line.angleBisector = _lineAngle;
+            payload.line.size = uniform(10, 60);
+        }
+        return payload;
+    }
+
+    IMUTXPayload imu() {
+        IMUTXPayload payload;
+        _robotAngle = wrap(_robotAngle + noise(50));
+        payload.imu.robotAngle = _robotAngle;
+        return payload;
+    }
+
+    TOFTXPayload tof() {
+        TOFTXPayload payload;
+        for (uint8_t i = 0; i < 4; ++i) payload.bounds.set(i, uniform(50, 900));
+        payload.bluetoothInboundPayload.masterIsStriker =
+            _scenario.masterIsStriker;
+        return payload;
+    }
+
+    CoralTXPayload coral() {
+        CoralTXPayload payload;
+        if (_scenario.seesBall) {
+            _ballAngle = wrap(_ballAngle + noise(500));
+            payload.camera.ballAngle = _ballAngle;
+            payload.camera.ballDistance = uniform(500, 8000);
+        }
+        if (_scenario.seesGoals) {
+            payload.camera.yellowGoalAngle = wrap(uniform(-3000, 3000));
+            payload.camera.yellowGoalDistance = uniform(3000, 15000);
+            payload.camera.blueGoalAngle = wrap(uniform(15000, 21000));
+            payload.camera.blueGoalDistance = uniform(3000, 15000);
+        }
+        return payload;
+    }
+
+  private:
+    int32_t uniform(int32_t min, int32_t max) {
+        return std::uniform_int_distribution<int32_t>(min, max)(_rng);
+    }
+    int32_t noise(int32_t amplitude) { return uniform(-amplitude, amplitude); }
+    // Wraps centidegrees to -179(.)99º to 180(.)00º
+    static int16_t wrap(int32_t angle) {
+        angle %= 36000;
+        return angle <= -18000 ? angle + 36000
+               : angle > 18000 ? angle - 36000
+                               : angle;
+    }
+
+    const Scenario &_scenario;
+    std::mt19937 _rng{2023};
+    int32_t _lineAngle = 9000;
+    int32_t _robotAngle = 0;
+    int32_t _ballAngle = 0;
+};
+
+// Times full passes of every scheduler task (sensors.read() → heading control
+// → runStriker()/runGoalie() → movement.update() → debug) on synthetic
+// packet streams, i.e. the worst case where every task is released at once.
+bool benchLoop() {
+    // The Teensy waits for the MUX, TOF and IMU before leaving setup()
+    PacketGenerator initGenerator(SCENARIOS[0]);
+    initGenerator.inject(0);
+    setup();
+
+    bool passed = true;
+    for (const auto &scenario : SCENARIOS) {
+        PacketGenerator generator(scenario);
+        BenchStats stats(BENCH_LOOP_ITERATIONS);
+        for (uint32_t i = 0; i < BENCH_LOOP_ITERATIONS; ++i) {
+            generator.inject(i);
+            stats.add(benchTime([] { scheduler.runAll(); }));
+        }
+        stats.print("loop", scenario.name);
+        if (stats.mean() > BENCH_LOOP_BUDGET) {
+            printf("[loop] %s exceeded the budget of %.3f µs\n", scenario.name,
+                   BENCH_LOOP_BUDGET);
+            passed = false;
+        }
+    }
+
+    // Per-task and per-zone execution times and link statistics over all
+    // scenarios
+    Serial.setEcho(true);
+    scheduler.printStats();
+    printProfile();
+    sensors.printLinkStats();
+    Serial.setEcho(false);
+
+    return passed;
+}
@@ -0,0 +1,223 @@
+#include <Arduino.h>
+#include <PacketSerial.h>
+#include <cstdio>
+
+#include "bench.h"
+#include "framing.h"
+#include "teensy/include/config.h"
+#include "teensy/include/serial_link.h"
+
+#define BENCH_LINK_PERIOD 2787 // in µs, between packets on the sender's clock
+
+// Counts a failed check, printing the first few.
+#define BENCH_LINK_CHECK(condition, ...)                                       \
+    do {                                                                       \
+        if (!(condition) && ++failures <= 10) {                                \
+            printf("[link] " __VA_ARGS__);                                     \
+            printf("\n");                                                      \
+        }                                                                      \
+    } while (0)
+
+// A link fed by the host, counting the packets that reach its handler.
+class Receiver {
+  public:
+    Receiver() {
+        link.setStream(&_serial);
+        link.setPacketHandler<&Receiver::onPacket>(*this);
+    }
+    Receiver(const Receiver &) = delete;
+
+    // Sends the packet numbered sequence, read at time on the sender's clock
+    // (in µs), and handles it. A corrupt one fails its CRC.
+    void send(const uint16_t sequence, const uint32_t time,
+              const bool corrupt = false) {
+        IMUTXPayload payload;
+        payload.header.sequence = sequence;
+        payload.header.time = time;
+
+        byte buf[sizeof(payload) + FRAME_OVERHEAD];
+        const auto frameSize = encodeFrame(
+            PAYLOAD_IMU_TX, (const byte *)&payload, sizeof(payload), buf);
+        if (corrupt) buf[frameSize - 1] ^= 0xFF;
+        byte encoded[sizeof(buf) + sizeof(buf) / 254 + 2];
+        const auto size = COBS::encode(buf, frameSize, encoded);
+        encoded[size] = 0;
+        _serial.inject(encoded, size + 1);
+        link.update();
+    }
+
+    // Sends the packets numbered from to to (inclusive, wrapping around), each
+    // read BENCH_LINK_PERIOD after the last from start.
+    void sendRun(const uint32_t from, const uint32_t to, const uint32_t start) {
+        for (uint32_t i = from; i <= to; ++i)
+            send(i, start + (i - from) * BENCH_LINK_PERIOD);
+    }
+
+    // Sends frames that fail their CRC.
+    void sendCorrupt(const uint16_t count) {
+        for (uint16_t i = 0; i < count; ++i) send(i, 0, true);
+    }
+
+    // Looks for the sender like Sensors::recoverLinks() does, without finding
+    // it.
+    void recover() {
+        link.setStream(nullptr);
+        link.setStream(&_serial);
+        link.recoveryAttempted();
+    }
+
+    void onPacket(const IMUTXPayload &payload) {
+        ++handled;
+        lastSequence = payload.header.sequence;
+    }
+
+    SerialLink link;
+    uint32_t handled = 0;
+    uint16_t lastSequence = 0;
+
+  private:
+    HardwareSerial _serial;
+};
+
+// Checks how SerialLink treats the sequence of the packets it receives: runs
+// wrapping around, late and repeated packets (dropped without disturbing the
+// sequence), gaps (counted as drops) and senders restarting (with their
+// sequence stepping back or, once wrapped, forwards, and their clock going
+// back). Then checks when it is lost, to silence or corrupt frames, and when
+// its sender is due to be looked for again.
+bool benchSerialLink() {
+    uint32_t failures = 0;
+
+    {
+        // Wrapping around is just another step
+        Receiver receiver;
+        receiver.sendRun(1, 70000, 0);
+        const auto &stats = receiver.link.stats();
+        BENCH_LINK_CHECK(receiver.handled == 70000 && stats.drops == 0 &&
+                             stats.reorders == 0 && stats.resyncs == 0,
+                         "wraparound: %u handled, %u drops, %u reorders, %u "
+                         "resyncs",
+                         receiver.handled, stats.drops, stats.reorders,
+                         stats.resyncs);
+    }
+
+    {
+        Receiver receiver;
+        receiver.sendRun(1, 20, 0);
+        // Late by a few packets
+        receiver.send(18, 17 * BENCH_LINK_PERIOD);
+        // As late as can be while still inside the window
+        const uint16_t oldest = 20 - (SERIAL_LINK_REORDER_WINDOW - 1);
+        receiver.send(oldest, (oldest - 1) * BENCH_LINK_PERIOD);
+        // Repeated
+        receiver.send(20, 19 * BENCH_LINK_PERIOD);
+        const auto &stats = receiver.link.stats();
+        BENCH_LINK_CHECK(receiver.handled == 20 && stats.reorders == 3 &&
+                             stats.resyncs == 0,
+                         "late packets: %u handled, %u reorders, %u resyncs",
+                         receiver.handled, stats.reorders, stats.resyncs);
+
+        // They didn't move the sequence back, so the next one follows on, and
+        // a gap after it is counted
+        receiver.send(21, 20 * BENCH_LINK_PERIOD);
+        receiver.send(30, 29 * BENCH_LINK_PERIOD);
+        BENCH_LINK_CHECK(receiver.handled == 22 &&
+                             receiver.lastSequence == 30 && stats.drops == 8 &&
+                             stats.resyncs == 0,
+                         "after late packets: %u handled, last %u, %u drops, "
+                         "%u resyncs",
+                         receiver.handled, receiver.lastSequence, stats.drops,
+                         stats.resyncs);
+    }
+
+    // Sender restarts from a clock at 300 ms, after sending first packets up
+    // to firstEnd on its clock
+    const auto checkRestart = [&](const char *name, const uint32_t first,
+                                  const uint32_t firstEnd) {
+        Receiver receiver;
+        receiver.sendRun(1, first, firstEnd - (first - 1) * BENCH_LINK_PERIOD);
+        receiver.sendRun(1, 100, 300000);
+        const auto &stats = receiver.link.stats();
+        BENCH_LINK_CHECK(receiver.handled == first + 100 &&
+                             stats.resyncs == 1 && stats.drops == 0 &&
+                             stats.reorders == 0,
+                         "restart %s: %u handled, %u resyncs, %u drops, %u "
+                         "reorders",
+                         name, receiver.handled, stats.resyncs, stats.drops,
+                         stats.reorders);
+    };
+    // The sequence steps back past the window, with the clock going on
+    checkRestart("after 100 packets", 100, 300000 - BENCH_LINK_PERIOD);
+    // The sequence steps back inside the window, but the clock goes back
+    // further than any packet could be late
+    checkRestart("after 10 packets", 10, 2000000);
+    // The sequence steps forwards (wrapped), with the clock going back a little
+    checkRestart("after 40000 packets", 40000, 350000);
+
+    {
+        // Silence, for longer than a short timeout (lost() is in ms)
+        Receiver receiver;
+        const auto start = micros();
+        while (micros() - start < 2000) continue;
+        const auto lostAfterSilence =
+            receiver.link.lost(1, LINK_LOST_CORRUPT_FRAMES);
+        receiver.send(1, 0);
+        BENCH_LINK_CHECK(lostAfterSilence &&
+                             !receiver.link.lost(1, LINK_LOST_CORRUPT_FRAMES) &&
+                             !receiver.link.lost(LINK_LOST_TIMEOUT,
+                                                 LINK_LOST_CORRUPT_FRAMES),
+                         "silence: %s, then %s after a packet",
+                         lostAfterSilence ? "lost" : "not lost",
+                         receiver.link.lost(1, LINK_LOST_CORRUPT_FRAMES)
+                             ? "lost"
+                             : "not lost");
+    }
+
+    {
+        // Lost to corrupt frames in a row, and due to be recovered at once
+        Receiver receiver;
+        auto &link = receiver.link;
+        receiver.sendCorrupt(LINK_LOST_CORRUPT_FRAMES - 1);
+        const auto lostEarly =
+            link.lost(LINK_LOST_TIMEOUT, LINK_LOST_CORRUPT_FRAMES);
+        const auto dueEarly = link.recoveryDue();
+        receiver.sendCorrupt(1);
+        BENCH_LINK_CHECK(!lostEarly && !dueEarly &&
+                             link.lost(LINK_LOST_TIMEOUT,
+                                       LINK_LOST_CORRUPT_FRAMES) &&
+                             link.recoveryDue(),
+                         "corrupt frames: %s after one too few, %s after "
+                         "enough",
+                         lostEarly || dueEarly ? "lost" : "not lost",
+                         link.recoveryDue() ? "due" : "not due");
+
+        // After looking for the sender, it is lost again as soon as enough
+        // corrupt frames follow, but not due until it has waited
+        receiver.recover();
+        const auto lostAfterAttempt =
+            link.lost(LINK_LOST_TIMEOUT, LINK_LOST_CORRUPT_FRAMES);
+        receiver.sendCorrupt(LINK_LOST_CORRUPT_FRAMES);
+        BENCH_LINK_CHECK(!lostAfterAttempt &&
+                             link.lost(LINK_LOST_TIMEOUT,
+                                       LINK_LOST_CORRUPT_FRAMES) &&
+                             !link.recoveryDue(),
+                         "after an attempt: %s at once, %s after corrupt "
+                         "frames",
+                         lostAfterAttempt ? "lost" : "not lost",
+                         link.recoveryDue() ? "due" : "not due");
+
+        // Once a packet is through, the wait is over, and the next loss is
+        // due at once again
+        receiver.send(1, 0);
+        const auto dueWhenBack = link.recoveryDue();
+        receiver.sendCorrupt(LINK_LOST_CORRUPT_FRAMES);
+        BENCH_LINK_CHECK(!dueWhenBack && link.recoveryDue(),
+                         "back: %s, then %s after corrupt frames",
+                         dueWhenBack ? "due" : "not due",
+                         link.recoveryDue() ? "due" : "not due");
+    }
+
+    printf("[link] sequence and loss checks %s (%u failures)\n",
+           failures == 0 ? "passed" : "failed", failures);
+    return failures == 0;
+}
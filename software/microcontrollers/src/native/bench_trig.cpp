@@ -0,0 +1,108 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "angle.h"
+#include "bench.h"
+
+#define BENCH_TRIG_BATCH_SIZE 1000
+
+// Times fn over a batch of inputs, per call.
+template <class Fn>
+static BenchStats benchBatch(const std::vector<float> &inputs, Fn &&fn) {
+    BenchStats stats(BENCH_TRIG_ITERATIONS);
+    for (uint32_t i = 0; i < BENCH_TRIG_ITERATIONS; ++i) {
+        stats.add(benchTime([&] {
+            for (const auto input : inputs) benchKeep(fn(input));
+        }) / inputs.size());
+    }
+    return stats;
+}
+
+// Measures the accuracy of sincosfd(), sinfd(), cosfd(), atan2fd() and
+// clipAngle() against double precision libm, and their throughput against
+// libm in single and double precision.
+bool benchTrig() {
+    // Accuracy
+    double maxSinError = 0, maxCosError = 0, maxAtan2Error = 0,
+           maxClipError = 0;
+    for (float x = -720.0F; x <= 720.0F; x += 0.001F) {
+        float sine, cosine;
+        sincosfd(x, sine, cosine);
+        maxSinError = fmax(maxSinError, fabs(sine - sin(x * M_PI / 180)));
+        maxCosError = fmax(maxCosError, fabs(cosine - cos(x * M_PI / 180)));
+        maxSinError = fmax(maxSinError, fabs(sinfd(x) - sin(x * M_PI / 180)));
+        maxCosError = fmax(maxCosError, fabs(cosfd(x) - cos(x * M_PI / 180)));
+
+        auto expectedClip = fmod((double)x, 360);
+        expectedClip = expectedClip <= -180  ? expectedClip + 360
+                       : expectedClip > 180 ? expectedClip - 360
+                                            : expectedClip;
+        maxClipError = fmax(maxClipError, fabs(clipAngle(x) - expectedClip));
+    }
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<float> coordinates(-500.0F, 500.0F);
+    for (uint32_t i = 0; i < 1000000; ++i) {
+        const auto x = coordinates(rng), y = coordinates(rng);
+        auto error = fabs(atan2fd(x, y) - atan2((double)x, y) * 180 / M_PI);
+        // ±180º are the same angle
+        error = fmin(error, 360 - error);
+        maxAtan2Error = fmax(maxAtan2Error, error);
+    }
+    printf("[trig] max error: sin=%.3g cos=%.3g atan2=%.3gº clipAngle=%.3gº\n",
+           maxSinError, maxCosError, maxAtan2Error, maxClipError);
+
+    // Floats without an angle give NaN, and huge ones are reduced exactly
+    bool guarded = true;
+    volatile float nonFinite[] = {NAN, INFINITY, -INFINITY};
+    for (const float x : nonFinite) {
+        float sine, cosine;
+        sincosfd(x, sine, cosine);
+        guarded &= floatExponent(sine) == FLOAT_EXPONENT_NONFINITE &&
+                   floatExponent(cosine) == FLOAT_EXPONENT_NONFINITE;
+    }
+    volatile float huge[] = {1e10F, -3e20F, 1e30F, 3.4e38F};
+    for (const float x : huge) {
+        float sine, cosine;
+        sincosfd(x, sine, cosine);
+        const auto radians = fmod((double)x, 360) * M_PI / 180;
+        guarded &= fabs(sine - sin(radians)) <= SINCOSFD_MAX_ERROR &&
+                   fabs(cosine - cos(radians)) <= SINCOSFD_MAX_ERROR;
+    }
+    printf("[trig] non-finite and huge angles %s\n",
+           guarded ? "handled" : "NOT handled");
+
+    // Throughput
+    std::vector<float> angles(BENCH_TRIG_BATCH_SIZE);
+    for (auto &angle : angles) angle = coordinates(rng);
+    benchBatch(angles, [](float x) {
+        float sine, cosine;
+        sincosfd(x, sine, cosine);
+        return sine + cosine;
+    }).print("trig", "sincosfd");
+    benchBatch(angles, [](float x) {
+        return sinf(x * DEG_TO_RADF) + cosf(x * DEG_TO_RADF);
+    }).print("trig", "sinf + cosf");
+    benchBatch(angles, [](float x) {
+        return sin(x * M_PI / 180) + cos(x * M_PI / 180);
+    }).print("trig", "sin + cos (double)");
+    benchBatch(angles, [](float x) {
+        return atan2fd(x, 100.0F - x);
+    }).print("trig", "atan2fd");
+    benchBatch(angles, [](float x) {
+        return atan2f(x, 100.0F - x) * RAD_TO_DEGF;
+    }).print("trig", "atan2f");
+    benchBatch(angles, [](float x) {
+        return atan2((double)x, 100.0 - x) * 180 / M_PI;
+    }).print("trig", "atan2 (double)");
+    benchBatch(angles, [](float x) { return clipAngle(x * 7); })
+        .print("trig", "clipAngle");
+    benchBatch(angles, [](float x) { return fmod((double)x * 7, 360); })
+        .print("trig", "fmod (double)");
+
+    return guarded && maxSinError <= SINCOSFD_MAX_ERROR &&
+           maxCosError <= SINCOSFD_MAX_ERROR &&
+           maxAtan2Error <= ATAN2FD_MAX_ERROR &&
+           maxClipError <= CLIPANGLE_MAX_ERROR;
+}
@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "vector.h"
+
+#define BENCH_VECTOR_BATCH_SIZE 1000
+#define HALF_GOAL_SEPARATION    107.5F // in cm, from teensy/include/config.h
+
+// Localises from both goals the way Sensors::_updateRobotPosition() used to.
+static Vector localisePolar(const Vector &offensive, const Vector &defensive) {
+    const auto fakeCenter = (offensive + defensive) / 2;
+    const auto scalingFactor =
+        (offensive - fakeCenter).distance / HALF_GOAL_SEPARATION;
+    const auto realCenter = fakeCenter * scalingFactor;
+    return -realCenter;
+}
+
+// Localises from both goals the way Sensors::_updateRobotPosition() does now.
+static CartesianVector localiseCartesian(const Vector &offensive,
+                                         const Vector &defensive) {
+    const CartesianVector offensive_ = offensive;
+    const CartesianVector defensive_ = defensive;
+    const auto fakeCenter = (offensive_ + defensive_) / 2;
+    const auto scalingFactor =
+        (offensive_ - fakeCenter).distance() / HALF_GOAL_SEPARATION;
+    const auto realCenter = fakeCenter * scalingFactor;
+    return -realCenter;
+}
+
+// Compares Vector with CartesianVector on the localisation path (goal vectors
+// → robot position → relative destination as in Movement::setMoveTo()).
+bool benchVector() {
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<float> angles(-179.99F, 180.0F);
+    std::uniform_real_distribution<float> distances(30.0F, 150.0F);
+    std::vector<Vector> goals(BENCH_VECTOR_BATCH_SIZE * 2);
+    for (auto &goal : goals) goal = {angles(rng), distances(rng)};
+    const Point destination = {0, -20};
+
+    BenchStats polarStats(BENCH_VECTOR_ITERATIONS);
+    BenchStats cartesianStats(BENCH_VECTOR_ITERATIONS);
+    float maxPositionError = 0;
+    for (uint32_t i = 0; i < BENCH_VECTOR_ITERATIONS; ++i) {
+        polarStats.add(benchTime([&] {
+            for (size_t j = 0; j < BENCH_VECTOR_BATCH_SIZE; ++j) {
+                const auto robot = localisePolar(goals[2 * j], goals[2 * j + 1]);
+                const auto relative = -robot + Vector::fromPoint(destination);
+                benchKeep(relative.angle);
+                benchKeep(relative.distance);
+            }
+        }) / BENCH_VECTOR_BATCH_SIZE);
+        cartesianStats.add(benchTime([&] {
+            for (size_t j = 0; j < BENCH_VECTOR_BATCH_SIZE; ++j) {
+                const auto robot =
+                    localiseCartesian(goals[2 * j], goals[2 * j + 1]);
+                const auto relative =
+                    CartesianVector::fromPoint(destination) - robot;
+                benchKeep(relative.angle());
+                benchKeep(relative.distance());
+            }
+        }) / BENCH_VECTOR_BATCH_SIZE);
+    }
+
+    // Both representations should agree on the robot position
+    for (size_t j = 0; j < BENCH_VECTOR_BATCH_SIZE; ++j) {
+        const CartesianVector polar =
+            localisePolar(goals[2 * j], goals[2 * j + 1]);
+        const auto cartesian =
+            localiseCartesian(goals[2 * j], goals[2 * j + 1]);
+        maxPositionError =
+            fmaxf(maxPositionError, (polar - cartesian).distance());
+    }
+
+    polarStats.print("vector", "Vector");
+    cartesianStats.print("vector", "CartesianVector");
+    printf("[vector] speedup=%.2fx, max position difference=%.6f cm\n",
+           polarStats.mean() / cartesianStats.mean(), maxPositionError);
+
+    return cartesianStats.mean() < polarStats.mean() &&
+           maxPositionError < BENCH_VECTOR_MAX_ERROR;
+}
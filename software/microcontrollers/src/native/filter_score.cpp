@@ -0,0 +1,148 @@
+#include "filter_score.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "ldr_filter.h"
+
+#define SCORE_LDR_COUNT        30
+#define SCORE_REFERENCE_RADIUS 2 // scans either side of each in the vote
+
+const std::vector<LDRFilterCandidate> LDR_FILTER_CANDIDATES = {
+    {"none", LDR_FILTER_K_OF_N, 1, 1, 0},
+    {"3 consecutive (old)", LDR_FILTER_K_OF_N, 3, 3, 0},
+    {"2 consecutive", LDR_FILTER_K_OF_N, 2, 2, 0},
+    {"2 of 3", LDR_FILTER_K_OF_N, 3, 2, 0},
+    {"3 of 4", LDR_FILTER_K_OF_N, 4, 3, 0},
+    {"3 of 5", LDR_FILTER_K_OF_N, 5, 3, 0},
+    {"hysteresis 2 on, 0 off of 4", LDR_FILTER_HYSTERESIS, 4, 2, 0},
+    {"hysteresis 3 on, 1 off of 5", LDR_FILTER_HYSTERESIS, 5, 3, 1},
+};
+
+struct LDRFilterScore {
+    uint32_t rises = 0, falls = 0;             // of the reference, followed
+    uint64_t riseLatency = 0, fallLatency = 0; // total, in scans
+    uint32_t missed = 0;        // the reference was on, but never the filter
+    uint32_t falseLines = 0;    // the filter was on, but never the reference
+    uint64_t disagreements = 0; // LDR-scans where they differ
+};
+
+// Returns which LDRs were hit in most of the scans around each scan.
+static std::vector<uint32_t> reference(const std::vector<uint32_t> &trace) {
+    std::vector<uint32_t> result(trace.size());
+    for (size_t t = 0; t < trace.size(); ++t) {
+        const auto first = t >= SCORE_REFERENCE_RADIUS
+                               ? t - SCORE_REFERENCE_RADIUS
+                               : 0;
+        const auto last =
+            std::min(t + SCORE_REFERENCE_RADIUS, trace.size() - 1);
+        for (uint8_t i = 0; i < SCORE_LDR_COUNT; ++i) {
+            uint8_t hits = 0;
+            for (auto s = first; s <= last; ++s) hits += trace[s] >> i & 1;
+            if (hits * 2 > last - first + 1) result[t] |= 1UL << i;
+        }
+    }
+    return result;
+}
+
+// Follows the output of a filter against the reference, one LDR at a time.
+static LDRFilterScore score(const std::vector<uint32_t> &output,
+                            const std::vector<uint32_t> &expected) {
+    LDRFilterScore result;
+    for (uint8_t i = 0; i < SCORE_LDR_COUNT; ++i) {
+        bool lastOn = false, lastExpectedOn = false;
+        bool awaitingRise = false, awaitingFall = false;
+        bool runExpected = false; // the reference was on during this run
+        size_t changeTime = 0;
+        for (size_t t = 0; t < output.size(); ++t) {
+            const bool on = output[t] >> i & 1;
+            const bool expectedOn = expected[t] >> i & 1;
+            result.disagreements += on != expectedOn;
+
+            if (expectedOn != lastExpectedOn) {
+                // A change the filter is yet to follow is given up on
+                if (awaitingRise) ++result.missed;
+                awaitingRise = expectedOn;
+                awaitingFall = !expectedOn;
+                changeTime = t;
+            }
+            if (awaitingRise && on) {
+                result.riseLatency += t - changeTime;
+                ++result.rises;
+                awaitingRise = false;
+            } else if (awaitingFall && !on) {
+                result.fallLatency += t - changeTime;
+                ++result.falls;
+                awaitingFall = false;
+            }
+
+            if (on && !lastOn) runExpected = false;
+            runExpected |= on && expectedOn;
+            if (!on && lastOn && !runExpected) ++result.falseLines;
+
+            lastOn = on;
+            lastExpectedOn = expectedOn;
+        }
+        if (awaitingRise) ++result.missed;
+    }
+    return result;
+}
+
+void scoreLDRFilters(const std::vector<uint32_t> &trace, const char *suite) {
+    const auto expected = reference(trace);
+    printf("[%s] %-28s %8s %8s %7s %7s %9s\n", suite, "filter (scans)",
+           "rise", "fall", "missed", "false", "disagree");
+    for (const auto &candidate : LDR_FILTER_CANDIDATES) {
+        LDRFilter filter;
+        filter.configure(candidate.policy, candidate.window,
+                         candidate.onThreshold, candidate.offThreshold);
+        std::vector<uint32_t> output;
+        output.reserve(trace.size());
+        for (const auto hits : trace) output.push_back(filter.update(hits));
+
+        const auto result = score(output, expected);
+        printf("[%s] %-28s %8.2f %8.2f %7u %7u %8.3f%%\n", suite,
+               candidate.name,
+               result.rises ? (float)result.riseLatency / result.rises : 0,
+               result.falls ? (float)result.fallLatency / result.falls : 0,
+               result.missed, result.falseLines,
+               100.0F * result.disagreements /
+                   (trace.size() * SCORE_LDR_COUNT));
+    }
+}
+
+// Reads the LDRs printLDR() marked as above their thresholds on each line,
+// i.e. two groups of 15 between |s, skipping any other lines.
+static bool readTrace(const char *path, std::vector<uint32_t> &trace) {
+    auto *file = fopen(path, "r");
+    if (file == nullptr) {
+        printf("[score] can't open %s\n", path);
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        const auto *start = strchr(line, '|');
+        const auto *middle = start ? strchr(start + 1, '|') : nullptr;
+        const auto *end = middle ? strchr(middle + 1, '|') : nullptr;
+        if (end == nullptr || middle - start != 16 || end - middle != 16)
+            continue;
+
+        const char *groups[2] = {start + 1, middle + 1};
+        uint32_t hits = 0;
+        for (uint8_t i = 0; i < SCORE_LDR_COUNT; ++i)
+            if (groups[i / 15][i % 15] == '1') hits |= 1UL << i;
+        trace.push_back(hits);
+    }
+    fclose(file);
+
+    printf("[score] %zu scans read from %s\n", trace.size(), path);
+    return !trace.empty();
+}
+
+int scoreLDRFilters(const char *path) {
+    std::vector<uint32_t> trace;
+    if (!readTrace(path, trace)) return 1;
+    scoreLDRFilters(trace, "score");
+    return 0;
+}
@@ -0,0 +1,78 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// A minimal stand-in for the Teensyduino core, just enough for the Teensy
+// control stack to compile and run on the host.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "wiring.h"
+
+typedef uint8_t byte;
+
+// Time (backed by the host's monotonic clock, until the time is set)
+uint32_t millis();
+uint32_t micros();
+// Host-side hook to stop the clock at a given time, e.g. for replays that run
+// as fast as possible
+void nativeSetMicros(uint32_t us);
+// Blocking delays only happen during initialisation (e.g. arming the
+// dribbler), so they return immediately on the host
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+// Cycle counter of a Teensy 4.0 running at F_CPU_ACTUAL, from the host clock
+#define F_CPU_ACTUAL   600000000
+#define ARM_DWT_CYCCNT nativeCycleCount()
+uint32_t nativeCycleCount();
+
+// Memory (there is only one kind on the host)
+#define DMAMEM
+
+// Pins
+#define HIGH   1
+#define LOW    0
+#define INPUT  0
+#define OUTPUT 1
+
+#define NATIVE_PIN_COUNT 64
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+inline void digitalWriteFast(uint8_t pin, uint8_t value) {
+    digitalWrite(pin, value);
+}
+uint8_t digitalRead(uint8_t pin);
+
+void analogReadResolution(unsigned int bits);
+void analogReadAveraging(unsigned int num);
+int analogRead(uint8_t pin);
+void analogWriteResolution(unsigned int bits);
+void analogWriteFrequency(uint8_t pin, float frequency);
+void analogWrite(uint8_t pin, int value);
+
+// Host-side hooks to drive and inspect the pins
+void nativeSetAnalogValue(uint8_t pin, int value);
+int nativeAnalogWriteValue(uint8_t pin);
+
+// Interrupts
+// There are no interrupts on the host, so IntervalTimer callbacks never run and
+// anything they service has to be polled as well
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class IntervalTimer {
+  public:
+    bool begin(void (*function)(), float period) { return true; }
+    void end() {}
+};
+
+#include "HardwareSerial.h"
+
+// Sketch entry points
+void setup();
+void loop();
+
+#endif
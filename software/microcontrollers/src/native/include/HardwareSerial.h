@@ -0,0 +1,53 @@
+#ifndef NATIVE_HARDWARESERIAL_H
+#define NATIVE_HARDWARESERIAL_H
+
+#include <cstdint>
+#include <deque>
+
+#include "Stream.h"
+
+// A serial port whose RX side is fed by the host and whose TX side is counted
+// (and optionally echoed to stdout) instead of being sent anywhere.
+class HardwareSerial : public Stream {
+  public:
+    HardwareSerial(bool echo = false) : _echo(echo) {}
+
+    void begin(uint32_t baud) { _baud = baud; }
+    void flush() {}
+    operator bool() const { return true; }
+
+    int available() override { return _rx.size(); }
+    int read() override {
+        if (_rx.empty()) return -1;
+        const auto value = _rx.front();
+        _rx.pop_front();
+        return value;
+    }
+    int peek() override { return _rx.empty() ? -1 : _rx.front(); }
+    // Writes never block on the host
+    int availableForWrite() override { return INT32_MAX; }
+    size_t write(uint8_t byte) override;
+    using Stream::write;
+
+    // Host-side hooks
+    void inject(const uint8_t *buffer, size_t size) {
+        _rx.insert(_rx.end(), buffer, buffer + size);
+    }
+    void setEcho(bool echo) { _echo = echo; }
+    uint32_t baud() const { return _baud; }
+    uint64_t txCount() const { return _txCount; }
+
+  private:
+    bool _echo;
+    uint32_t _baud = 0;
+    uint64_t _txCount = 0;
+    std::deque<uint8_t> _rx;
+};
+
+extern HardwareSerial Serial; // USB
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+extern HardwareSerial Serial3;
+extern HardwareSerial Serial4;
+
+#endif
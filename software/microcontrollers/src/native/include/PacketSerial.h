@@ -0,0 +1,111 @@
+#ifndef NATIVE_PACKETSERIAL_H
+#define NATIVE_PACKETSERIAL_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+// A stand-in for bakercp/PacketSerial's COBS encoder.
+class COBS {
+  public:
+    static size_t encode(const uint8_t *buffer, size_t size,
+                         uint8_t *encodedBuffer) {
+        size_t readIndex = 0, writeIndex = 1, codeIndex = 0;
+        uint8_t code = 1;
+        while (readIndex < size) {
+            if (buffer[readIndex] == 0) {
+                encodedBuffer[codeIndex] = code;
+                code = 1;
+                codeIndex = writeIndex++;
+                ++readIndex;
+            } else {
+                encodedBuffer[writeIndex++] = buffer[readIndex++];
+                if (++code == 0xFF) {
+                    encodedBuffer[codeIndex] = code;
+                    code = 1;
+                    codeIndex = writeIndex++;
+                }
+            }
+        }
+        encodedBuffer[codeIndex] = code;
+        return writeIndex;
+    }
+
+    static size_t decode(const uint8_t *encodedBuffer, size_t size,
+                         uint8_t *decodedBuffer) {
+        size_t readIndex = 0, writeIndex = 0;
+        while (readIndex < size) {
+            const uint8_t code = encodedBuffer[readIndex];
+            if (readIndex + code > size && code != 1) return 0;
+            ++readIndex;
+            for (uint8_t i = 1; i < code; ++i)
+                decodedBuffer[writeIndex++] = encodedBuffer[readIndex++];
+            if (code != 0xFF && readIndex != size)
+                decodedBuffer[writeIndex++] = 0;
+        }
+        return writeIndex;
+    }
+
+    static size_t getEncodedBufferSize(size_t unencodedBufferSize) {
+        return unencodedBufferSize + unencodedBufferSize / 254 + 1;
+    }
+};
+
+// A stand-in for bakercp/PacketSerial's COBS-framed PacketSerial (zero
+// delimiter, 256 byte receive buffer) with the same public interface.
+class PacketSerial {
+  public:
+    typedef void (*PacketHandlerFunction)(const uint8_t *buffer, size_t size);
+
+    static const size_t ReceiveBufferSize = 256;
+
+    void setStream(Stream *stream) { _stream = stream; }
+    Stream *getStream() { return _stream; }
+    void setPacketHandler(PacketHandlerFunction onPacketFunction) {
+        _onPacketFunction = onPacketFunction;
+    }
+
+    // Decodes every complete packet currently available on the stream.
+    void update() {
+        if (_stream == nullptr) return;
+
+        while (_stream->available() > 0) {
+            const uint8_t data = _stream->read();
+            if (data == 0) {
+                if (_onPacketFunction != nullptr && _receiveBufferIndex > 0) {
+                    uint8_t decodeBuffer[ReceiveBufferSize];
+                    const auto size = COBS::decode(
+                        _receiveBuffer, _receiveBufferIndex, decodeBuffer);
+                    _onPacketFunction(decodeBuffer, size);
+                }
+                _receiveBufferIndex = 0;
+                _receiveBufferOverflow = false;
+            } else if (_receiveBufferIndex < ReceiveBufferSize) {
+                _receiveBuffer[_receiveBufferIndex++] = data;
+            } else {
+                _receiveBufferOverflow = true;
+            }
+        }
+    }
+
+    // COBS-encodes a packet and writes it to the stream with its delimiter.
+    void send(const uint8_t *buffer, size_t size) {
+        if (_stream == nullptr || buffer == nullptr || size == 0) return;
+
+        uint8_t encodeBuffer[ReceiveBufferSize + ReceiveBufferSize / 254 + 2];
+        const auto encodedSize = COBS::encode(buffer, size, encodeBuffer);
+        _stream->write(encodeBuffer, encodedSize);
+        _stream->write((uint8_t)0);
+    }
+
+    bool overflow() const { return _receiveBufferOverflow; }
+
+  private:
+    Stream *_stream = nullptr;
+    PacketHandlerFunction _onPacketFunction = nullptr;
+    uint8_t _receiveBuffer[ReceiveBufferSize];
+    size_t _receiveBufferIndex = 0;
+    bool _receiveBufferOverflow = false;
+};
+
+#endif
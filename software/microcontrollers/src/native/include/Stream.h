@@ -0,0 +1,55 @@
+#ifndef NATIVE_STREAM_H
+#define NATIVE_STREAM_H
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Byte stream with the subset of the Arduino Print/Stream interface we use.
+class Stream {
+  public:
+    virtual ~Stream() {}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual int availableForWrite() { return 0; }
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        for (size_t i = 0; i < size; ++i) write(buffer[i]);
+        return size;
+    }
+    size_t write(const char *str) {
+        return write((const uint8_t *)str, strlen(str));
+    }
+
+    size_t print(const char *value) { return write(value); }
+    size_t print(char value) { return write((uint8_t)value); }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t print(double value, int digits = 2) {
+        return printf("%.*f", digits, value);
+    }
+    template <class T> size_t println(T value) {
+        return print(value) + println();
+    }
+    size_t println() { return write("\r\n"); }
+
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        const auto length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (length < 0) return length;
+        return write((const uint8_t *)buffer,
+                     length < (int)sizeof(buffer) ? length
+                                                  : sizeof(buffer) - 1);
+    }
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef NATIVE_BENCH_H
+#define NATIVE_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Budgets (a suite fails if its mean exceeds these on the host)
+// These are host times, not Teensy times, so compare against a baseline run on
+// the same machine and override them with -D in platformio.ini if needed
+#ifndef BENCH_LOOP_BUDGET
+    #define BENCH_LOOP_BUDGET 5.0F // in µs, per loop() iteration
+#endif
+
+#define BENCH_LOOP_ITERATIONS              50000
+#define BENCH_VECTOR_ITERATIONS            200
+#define BENCH_VECTOR_MAX_ERROR             0.01F // in cm
+#define BENCH_TRIG_ITERATIONS              200
+#define BENCH_CORAL_ITERATIONS             200
+#define BENCH_LINE_ITERATIONS              2000
+#define BENCH_LINE_MAX_ACTIVE              6 // checks every pattern up to this
+#define BENCH_LINE_RANDOM_PATTERNS         100000
+#define BENCH_FILTER_ITERATIONS            2000
+#define BENCH_FILTER_CHECK_SCANS           2000 // for each policy
+#define BENCH_FILTER_SCANS                 200000 // in the synthetic trace
+#define BENCH_FILTER_MISS_PROBABILITY      0.05
+#define BENCH_FILTER_FALSE_HIT_PROBABILITY 0.01
+#define BENCH_MOTION_SETTLE_SPAN           72.0F // in º, before checking rates
+#define BENCH_MOTION_MAX_TIME_ERROR        100.0F // in ms
+#define BENCH_MOTION_MAX_ANGLE_RATE_ERROR  30.0F // in º/s, turning at 30º/s
+
+// Collects per-iteration samples and summarises them.
+class BenchStats {
+  public:
+    explicit BenchStats(size_t capacity = 0) { _samples.reserve(capacity); }
+
+    void add(uint64_t ns) { _samples.push_back(ns); }
+    size_t count() const { return _samples.size(); }
+
+    float mean() const; // in µs
+    float min() const;  // in µs
+    float max() const;  // in µs
+    float percentile(float p) const; // in µs
+
+    void print(const char *suite, const char *name) const;
+
+  private:
+    std::vector<uint64_t> _samples; // in ns
+};
+
+// Returns the time taken to call fn in ns.
+template <class Fn> inline uint64_t benchTime(Fn &&fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+        .count();
+}
+
+// Keeps the compiler from optimising away a benchmarked result.
+template <class T> inline void benchKeep(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Suites, each returns false if it exceeded its budget
+bool benchLoop();
+bool benchVector();
+bool benchTrig();
+bool benchCoral();
+bool benchLine();
+bool benchFilter();
+bool benchAngle();
+bool benchLineMotion();
+bool benchSerialLink();
+
+#endif
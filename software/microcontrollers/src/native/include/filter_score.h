@@ -0,0 +1,26 @@
+#ifndef NATIVE_FILTER_SCORE_H
+#define NATIVE_FILTER_SCORE_H
+
+#include <cstdint>
+#include <vector>
+
+// An LDRFilter policy (see ldr_filter.h) to score
+struct LDRFilterCandidate {
+    const char *name;
+    uint8_t policy;
+    uint8_t window;
+    uint8_t onThreshold;
+    uint8_t offThreshold;
+};
+extern const std::vector<LDRFilterCandidate> LDR_FILTER_CANDIDATES;
+
+// Scores every candidate on a trace of which LDRs were above their thresholds
+// in each scan (bit i for LDR i), printing a line for each. As there is no
+// ground truth, each is compared with a majority vote over the scans around
+// each scan, which no causal filter can see.
+void scoreLDRFilters(const std::vector<uint32_t> &trace, const char *suite);
+// Reads a trace printed by printLDR() on the STM32 MUX and scores every
+// candidate on it. Returns the exit status.
+int scoreLDRFilters(const char *path);
+
+#endif
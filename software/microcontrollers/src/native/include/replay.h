@@ -0,0 +1,10 @@
+#ifndef NATIVE_REPLAY_H
+#define NATIVE_REPLAY_H
+
+// Replays a flight recorder dump (see tools/flight_recorder.py) through the
+// Teensy's setup() and scheduler in virtual time, writing what the robot saw
+// and decided to a CSV every strategy period so that builds can be diffed.
+// Returns the exit status.
+int replay(const char *path, const char *csvPath);
+
+#endif
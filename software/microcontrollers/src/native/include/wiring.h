@@ -0,0 +1,33 @@
+#ifndef NATIVE_WIRING_H
+#define NATIVE_WIRING_H
+
+#include <cmath>
+#include <utility>
+
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+// newlib provides this, glibc doesn't
+inline float infinityf() { return INFINITY; }
+
+// Same semantics as the Teensyduino templates, which allow mixed types
+template <class A, class B>
+constexpr auto min(A &&a, B &&b)
+    -> decltype(a < b ? std::forward<A>(a) : std::forward<B>(b)) {
+    return a < b ? std::forward<A>(a) : std::forward<B>(b);
+}
+template <class A, class B>
+constexpr auto max(A &&a, B &&b)
+    -> decltype(a < b ? std::forward<A>(a) : std::forward<B>(b)) {
+    return a >= b ? std::forward<A>(a) : std::forward<B>(b);
+}
+
+#define constrain(amt, low, high)                                              \
+    ({                                                                         \
+        auto _amt = (amt);                                                     \
+        auto _low = (low);                                                     \
+        auto _high = (high);                                                   \
+        (_amt < _low) ? _low : ((_amt > _high) ? _high : _amt);                \
+    })
+
+#endif
@@ -0,0 +1,58 @@
+#include <cstdio>
+#include <cstring>
+
+#include "bench.h"
+#include "filter_score.h"
+#include "replay.h"
+
+struct Suite {
+    const char *name;
+    bool (*run)();
+};
+
+const Suite SUITES[] = {
+    {"loop", benchLoop},
+    {"vector", benchVector},
+    {"trig", benchTrig},
+    {"coral", benchCoral},
+    {"line", benchLine},
+    {"filter", benchFilter},
+    {"angle", benchAngle},
+    {"motion", benchLineMotion},
+    {"link", benchSerialLink},
+};
+
+// Runs every benchmark suite, or only those named on the command line, and
+// exits with a non-zero status if any of them exceeded its budget. Or, with
+// "replay <dump> <csv>", replays a flight recorder dump, and with
+// "score <trace>", scores the LDR filters on a trace printed by the MUX.
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "replay") == 0) {
+        if (argc != 4) {
+            printf("usage: %s replay <dump> <csv>\n", argv[0]);
+            return 1;
+        }
+        return replay(argv[2], argv[3]);
+    }
+    if (argc > 1 && strcmp(argv[1], "score") == 0) {
+        if (argc != 3) {
+            printf("usage: %s score <trace>\n", argv[0]);
+            return 1;
+        }
+        return scoreLDRFilters(argv[2]);
+    }
+
+    bool passed = true;
+    for (const auto &suite : SUITES) {
+        bool selected = argc <= 1;
+        for (int i = 1; i < argc; ++i)
+            if (strcmp(argv[i], suite.name) == 0) selected = true;
+        if (!selected) continue;
+
+        if (!suite.run()) {
+            printf("[%s] FAILED\n", suite.name);
+            passed = false;
+        }
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <PacketSerial.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "flight_recorder.h"
+#include "replay.h"
+#include "teensy/include/config.h"
+#include "teensy/include/main.h"
+
+// One entry of a flight recorder dump.
+struct ReplayEntry {
+    FlightRecorderEntryHeader header;
+    std::vector<uint8_t> data;
+};
+
+// Reads the COBS-framed entries of a dump up to its end marker, skipping any
+// that are corrupted.
+static bool readDump(const char *path, std::vector<ReplayEntry> &entries) {
+    auto *file = fopen(path, "rb");
+    if (file == nullptr) {
+        printf("[replay] can't open %s\n", path);
+        return false;
+    }
+
+    std::vector<uint8_t> encoded;
+    uint8_t decoded[sizeof(FlightRecorderEntryHeader) +
+                    FLIGHT_RECORDER_MAX_DATA_SIZE + 2];
+    uint32_t skipped = 0;
+    int byte;
+    while ((byte = fgetc(file)) != EOF) {
+        if (byte != 0) {
+            encoded.push_back(byte);
+            continue;
+        }
+        if (encoded.empty()) continue;
+
+        // Decoding never produces more bytes than it is given
+        ReplayEntry entry;
+        const auto size =
+            encoded.size() <= sizeof(decoded)
+                ? COBS::decode(encoded.data(), encoded.size(), decoded)
+                : 0;
+        encoded.clear();
+        if (size >= sizeof(entry.header))
+            memcpy(&entry.header, decoded, sizeof(entry.header));
+        if (size < sizeof(entry.header) ||
+            sizeof(entry.header) + entry.header.size != size) {
+            ++skipped;
+            continue;
+        }
+        if (entry.header.source == FLIGHT_RECORDER_END) break;
+        entry.data.assign(decoded + sizeof(entry.header),
+                          decoded + sizeof(entry.header) + entry.header.size);
+        entries.push_back(entry);
+    }
+    fclose(file);
+
+    printf("[replay] %zu entries read from %s (%u skipped)\n", entries.size(),
+           path, skipped);
+    return !entries.empty();
+}
+
+// Feeds an entry to where it came from, as it came.
+static void inject(const ReplayEntry &entry) {
+    HardwareSerial *serial = nullptr;
+    switch (entry.header.source) {
+    case FLIGHT_RECORDER_MUX:
+        serial = &MUX_SERIAL;
+        break;
+    case FLIGHT_RECORDER_TOF:
+        serial = &TOF_SERIAL;
+        break;
+    case FLIGHT_RECORDER_IMU:
+        serial = &IMU_SERIAL;
+        break;
+    case FLIGHT_RECORDER_CORAL:
+        serial = &CORAL_SERIAL;
+        break;
+    case FLIGHT_RECORDER_LIGHTGATE:
+        // Already debounced, so it is applied as it was on the robot
+        if (entry.data.size() == sizeof(uint8_t))
+            lightgate.inject(entry.data[0]);
+        return;
+    default:
+        return;
+    }
+
+    // Re-encode the frame like the STM32s and the Coral would
+    uint8_t encoded[FLIGHT_RECORDER_MAX_DATA_SIZE +
+                    FLIGHT_RECORDER_MAX_DATA_SIZE / 254 + 2];
+    const auto size =
+        COBS::encode(entry.data.data(), entry.data.size(), encoded);
+    encoded[size] = 0; // delimiter byte
+    serial->inject(encoded, size + 1);
+}
+
+// Writes what the robot saw and decided.
+static void writeRow(FILE *csv) {
+    fprintf(csv,
+            "%u,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%d,%.2f,%d,%.2f,%d,0x%08x\n",
+            micros(), sensors.robot.angle.value, sensors.line.angleBisector,
+            sensors.line.depth, sensors.ball.value.angle,
+            sensors.ball.value.distance, movement.angle, movement.velocity,
+            movement.heading, movement.dribble, sensors.bounds.front.value,
+            sensors.hasBall, sensors.ldrs.activations);
+}
+
+int replay(const char *path, const char *csvPath) {
+    std::vector<ReplayEntry> entries;
+    if (!readDump(path, entries)) return 1;
+    auto *csv = fopen(csvPath, "w");
+    if (csv == nullptr) {
+        printf("[replay] can't open %s\n", csvPath);
+        return 1;
+    }
+    fprintf(csv, "time,robot_angle,line_angle,line_depth,ball_angle,"
+                 "ball_distance,movement_angle,movement_velocity,"
+                 "movement_heading,dribble,bounds_front,has_ball,"
+                 "ldr_activations\n");
+
+    // The Teensy waits for the MUX, TOF and IMU before leaving setup(), so
+    // give it everything up to the first packet of each
+    size_t next = 0;
+    bool seen[FLIGHT_RECORDER_CORAL + 1] = {};
+    while (next < entries.size() && !(seen[FLIGHT_RECORDER_MUX] &&
+                                      seen[FLIGHT_RECORDER_TOF] &&
+                                      seen[FLIGHT_RECORDER_IMU])) {
+        const auto &entry = entries[next++];
+        nativeSetMicros(entry.header.time);
+        inject(entry);
+        if (entry.header.source <= FLIGHT_RECORDER_CORAL)
+            seen[entry.header.source] = true;
+    }
+    setup();
+
+    // Step through the recording in virtual time, feeding in each entry when
+    // it was received
+    auto time = entries[next < entries.size() ? next : next - 1].header.time;
+    auto nextRow = time;
+    uint32_t rows = 0;
+    while (next < entries.size()) {
+        while (next < entries.size() &&
+               (int32_t)(entries[next].header.time - time) <= 0)
+            inject(entries[next++]);
+        nativeSetMicros(time);
+        scheduler.run();
+        if ((int32_t)(time - nextRow) >= 0) {
+            writeRow(csv);
+            ++rows;
+            nextRow += TASK_PERIOD_STRATEGY;
+        }
+        time += TASK_PERIOD_SERIAL;
+    }
+    fclose(csv);
+
+    printf("[replay] %u rows written to %s\n", rows, csvPath);
+    return 0;
+}
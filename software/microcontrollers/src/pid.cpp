@@ -27,12 +27,13 @@ float PIDController::advance(const float input, const float scaler,
                                      -_maxSetpointChange, _maxSetpointChange);
     _setpoint += dsetpoint;
 
-    // If dt is too short, don't advance the controller yet
-    if (micros() - _lastTime < _minDt) return _lastOutput;
+    // If dt is too short, don't advance the controller yet (unless the caller
+    // guarantees a fixed dt)
+    if (_fixedDt == 0 && micros() - _lastTime < _minDt) return _lastOutput;
 
     // Find dt
     const auto now = micros();
-    const auto dt = now - _lastTime;
+    const auto dt = _fixedDt != 0 ? _fixedDt : now - _lastTime;
     _lastTime = now;
 
     // Find PID components
@@ -103,26 +104,22 @@ void PIDController::updateGains(const float kp, const float ki,
     _kd = kd;
 }
 
-void PIDController::debugPrint(const char *name, Stream &serial) {
-    const auto printFloat = [&serial](const float value) {
-        serial.printf("%5d.%02d", (int)value, abs((int)(value * 100) % 100));
-    };
-
-    if (name != nullptr) serial.printf("[%s] ", name);
-    serial.printf("Setpoint: ");
-    printFloat(_targetSetpoint);
-    serial.printf(" | Input: ");
-    printFloat(_lastInput);
-    serial.printf(" | Error: ");
-    printFloat(_lastError);
-    serial.printf(" | Output: ");
-    printFloat(_lastOutput);
-    serial.printf(" | P: ");
-    printFloat(_lastP);
-    serial.printf(" | I: ");
-    printFloat(_lastI);
-    serial.printf(" | D: ");
-    printFloat(_lastD);
-    serial.printf(" | dt: %4d", _lastDt);
-    serial.println();
-}
\ No newline at end of file
+// Use a fixed dt (in µs) instead of measuring it, for controllers that are
+// advanced at a fixed rate. This also bypasses minDt.
+void PIDController::setFixedDt(const uint32_t dt) { _fixedDt = dt; }
+
+// Records the internal values of the controller, tagged with id.
+void PIDController::sendTelemetry(Telemetry &telemetry,
+                                  const uint8_t id) const {
+    TelemetryPIDRecord record;
+    record.id = id;
+    record.setpoint = _targetSetpoint;
+    record.input = _lastInput;
+    record.error = _lastError;
+    record.output = _lastOutput;
+    record.p = _lastP;
+    record.i = _lastI;
+    record.d = _lastD;
+    record.dt = _lastDt;
+    telemetry.send(record);
+}
@@ -0,0 +1,101 @@
+#include "profiler.h"
+
+#include <Arduino.h>
+
+ProfilerZone *ProfilerZone::_first = nullptr;
+
+ProfilerZone::ProfilerZone(const char *name) : _name(name) {
+    // Append to the list of zones
+    auto **last = &_first;
+    while (*last != nullptr) last = &(*last)->_next;
+    *last = this;
+}
+
+void ProfilerZone::record(const uint32_t cycles) {
+    ++_histogram[_bucket(cycles)];
+    ++_count;
+    _total += cycles;
+    if (cycles > _max) _max = cycles;
+}
+
+void ProfilerZone::reset() {
+    _histogram.fill(0);
+    _count = 0;
+    _max = 0;
+    _total = 0;
+}
+
+uint32_t ProfilerZone::mean() const {
+    return _count > 0 ? _total / _count : 0;
+}
+
+// Finds the nearest-rank percentile from the histogram.
+uint32_t ProfilerZone::percentile(const float p) const {
+    if (_count == 0) return 0;
+    const auto rank = (uint32_t)ceilf(p / 100 * _count);
+    uint32_t seen = 0;
+    for (uint16_t i = 0; i < PROFILER_BUCKET_COUNT; ++i) {
+        seen += _histogram[i];
+        if (seen >= rank && seen > 0) return min(_bucketMidpoint(i), _max);
+    }
+    return _max;
+}
+
+uint16_t ProfilerZone::_bucket(const uint32_t cycles) {
+    const uint32_t subBuckets = 1 << PROFILER_SUB_BUCKET_BITS;
+    if (cycles < subBuckets) return cycles;
+    // Use the leading bits below the most significant one as the sub-bucket
+    const uint32_t exponent = 31 - __builtin_clz(cycles);
+    if (exponent > PROFILER_MAX_BITS) return PROFILER_BUCKET_COUNT - 1;
+    const uint32_t mantissa =
+        (cycles >> (exponent - PROFILER_SUB_BUCKET_BITS)) & (subBuckets - 1);
+    return ((exponent - PROFILER_SUB_BUCKET_BITS + 1)
+            << PROFILER_SUB_BUCKET_BITS) +
+           mantissa;
+}
+
+uint32_t ProfilerZone::_bucketMidpoint(const uint16_t bucket) {
+    const uint32_t subBuckets = 1 << PROFILER_SUB_BUCKET_BITS;
+    if (bucket < subBuckets) return bucket;
+    const uint32_t exponent =
+        (bucket >> PROFILER_SUB_BUCKET_BITS) + PROFILER_SUB_BUCKET_BITS - 1;
+    const uint32_t mantissa = bucket & (subBuckets - 1);
+    const uint32_t shift = exponent - PROFILER_SUB_BUCKET_BITS;
+    return ((subBuckets + mantissa) << shift) + ((1 << shift) >> 1);
+}
+
+// Enables the cycle counter (the Teensy core normally does this already).
+void initProfiler() {
+#if defined(ARM_DEMCR) && defined(ARM_DWT_CTRL)
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+#endif
+}
+
+// Prints the execution time distribution of every zone in µs.
+void printProfile(Stream &serial) {
+    const auto printMicros = [&serial](const uint32_t cycles) {
+        const auto centimicros =
+            (uint64_t)cycles * 100 / PROFILER_CYCLES_PER_MICRO;
+        serial.printf(" %6u.%02u", (uint32_t)(centimicros / 100),
+                      (uint32_t)(centimicros % 100));
+    };
+
+    serial.printf("Profile (µs)          count       mean        p50        "
+                  "p99        max\n");
+    for (auto *zone = ProfilerZone::first(); zone != nullptr;
+         zone = zone->next()) {
+        serial.printf("%-20s %8u  ", zone->name(), zone->count());
+        printMicros(zone->mean());
+        printMicros(zone->percentile(50));
+        printMicros(zone->percentile(99));
+        printMicros(zone->max());
+        serial.println();
+    }
+}
+
+void resetProfile() {
+    for (auto *zone = ProfilerZone::first(); zone != nullptr;
+         zone = zone->next())
+        zone->reset();
+}
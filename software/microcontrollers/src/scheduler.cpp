@@ -0,0 +1,91 @@
+#include "scheduler.h"
+
+#include <Arduino.h>
+
+// Adds a task that is released every period µs. Returns false if there is no
+// space left for it.
+bool Scheduler::add(const char *name, TaskFunction function,
+                    const uint32_t period, const uint8_t priority) {
+    if (_taskCount == SCHEDULER_MAX_TASKS) return false;
+
+    // Keep the tasks sorted by priority so run() can go through them in order
+    uint8_t i = _taskCount++;
+    for (; i > 0 && _tasks[i - 1].priority > priority; --i)
+        _tasks[i] = _tasks[i - 1];
+    _tasks[i] = Task();
+    _tasks[i].name = name;
+    _tasks[i].function = function;
+    _tasks[i].period = period;
+    _tasks[i].priority = priority;
+    _tasks[i].nextRelease = micros();
+    return true;
+}
+
+// Runs every task that has been released, in order of priority, or the idle
+// task if there are none.
+void Scheduler::run() {
+    bool idle = true;
+    for (uint8_t i = 0; i < _taskCount; ++i) {
+        auto &task = _tasks[i];
+        if ((int32_t)(micros() - task.nextRelease) < 0) continue;
+
+        idle = false;
+        const auto end = _execute(task);
+
+        // Each release has to finish before the next one (implicit deadline)
+        task.nextRelease += task.period;
+        if ((int32_t)(end - task.nextRelease) > 0) {
+            ++task.misses;
+            // Skip over whole periods we have fallen behind by, counting them
+            // as misses, while keeping to the original phase
+            const auto skipped = (end - task.nextRelease) / task.period;
+            task.misses += skipped;
+            task.nextRelease += skipped * task.period;
+        }
+    }
+
+    if (idle && _idleFunction != nullptr) _idleFunction();
+}
+
+void Scheduler::runAll() {
+    for (uint8_t i = 0; i < _taskCount; ++i) _execute(_tasks[i]);
+}
+
+// Prints the statistics of every task.
+void Scheduler::printStats(Stream &serial) const {
+    for (uint8_t i = 0; i < _taskCount; ++i) {
+        const auto &task = _tasks[i];
+        serial.printf("[%-10s] period=%6u runs=%8u misses=%6u exec (µs): "
+                      "mean=%5u last=%5u max=%5u\n",
+                      task.name, task.period, task.runs, task.misses,
+                      task.runs > 0
+                          ? (uint32_t)(task.totalExecutionTime / task.runs)
+                          : 0,
+                      task.lastExecutionTime, task.maxExecutionTime);
+    }
+}
+
+void Scheduler::resetStats() {
+    for (uint8_t i = 0; i < _taskCount; ++i) {
+        _tasks[i].runs = 0;
+        _tasks[i].misses = 0;
+        _tasks[i].lastExecutionTime = 0;
+        _tasks[i].maxExecutionTime = 0;
+        _tasks[i].totalExecutionTime = 0;
+    }
+}
+
+// Runs a task and records its execution time. Returns the time it ended.
+uint32_t Scheduler::_execute(Task &task) {
+    const auto start = micros();
+    task.function();
+    const auto end = micros();
+
+    const auto executionTime = end - start;
+    ++task.runs;
+    task.lastExecutionTime = executionTime;
+    task.totalExecutionTime += executionTime;
+    if (executionTime > task.maxExecutionTime)
+        task.maxExecutionTime = executionTime;
+    return end;
+}
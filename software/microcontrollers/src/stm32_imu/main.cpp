@@ -6,15 +6,19 @@
 #include <array>
 
 #include "angle.h"
+#include "framing.h"
+#include "link_test.h"
 #include "shared_config.h"
 #include "stm32_imu/include/config.h"
 #include "util.h"
 
 // State
 IMUData imuData;
+PacketHeader header;
 
 // Serial managers
 PacketSerial teensySerial;
+uint32_t corruptFrames = 0;
 
 // IMU (Sensor ID, I2C Address, I2C Wire)
 Adafruit_BNO055 bno = Adafruit_BNO055(55, I2C_ADDRESS_BNO055, &Wire);
@@ -102,10 +106,21 @@ void calibrate() {
 
 // ------------------------------ MAIN CODE START ------------------------------
 void onTeensyPacket(const byte *buf, size_t size) {
-    MUXRXPayload payload;
+    // Answer link tests from the Teensy
+    if (respondToLinkTest(buf, size, TEENSY_SERIAL, teensySerial)) return;
+
+    // Drop corrupted frames
+    const byte *payloadBuf;
+    size_t payloadSize;
+    if (!decodeFrame(buf, size, PAYLOAD_IMU_RX, payloadBuf, payloadSize)) {
+        ++corruptFrames;
+        return;
+    }
+
+    IMURXPayload payload;
     // Don't continue if the payload is invalid
-    if (size != sizeof(payload)) return;
-    memcpy(&payload, buf, sizeof(payload));
+    if (payloadSize != sizeof(payload)) return;
+    memcpy(&payload, payloadBuf, sizeof(payload));
 
     // If the STM32 is in calibration mode, run the BNO055 calibration routine
     if (payload.calibrating) { // defaults to false
@@ -169,11 +184,13 @@ void loop() {
     // Read IMU data
     imuData.newData = true;
     imuData.robotAngle = roundf(readRobotAngle() * 100); // probably blocking
+    header.advance(micros());
 
     // Send the IMU data over serial to Teensy
-    byte buf[sizeof(IMUTXPayload)];
-    memcpy(buf, &imuData, sizeof(imuData));
-    teensySerial.send(buf, sizeof(buf));
+    IMUTXPayload payload;
+    payload.header = header;
+    payload.imu = imuData;
+    sendFrame(teensySerial, PAYLOAD_IMU_TX, payload);
     imuData.newData = false;
 
     // ------------------------------ START DEBUG ------------------------------
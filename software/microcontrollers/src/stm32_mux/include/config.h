@@ -33,6 +33,8 @@
 #define PIN_LDRMUX2_S1  PA6
 #define PIN_LDRMUX2_S2  PA5
 #define PIN_LDRMUX2_S3  PA4
+// The select pins of both MUXs must be on the same GPIO port, as they are all
+// set at once
 
 // Tell the compiler the specific pins each HardwareSerial uses
 #ifdef DEBUG
@@ -45,11 +47,24 @@
 #define PIN_TEENSY_SERIAL_TX PA2
 #define TEENSY_SERIAL        Serial2
 
+// EEPROM Addresses
+#define EEPROM_ADDRESS_PARAMETERS 0x000
+// Marks saved parameters, change this if MUXParameters changes
+#define EEPROM_PARAMETERS_MAGIC 0x4D04
+
 // Light Sensor Config
-enum LDRMUX { MUX1 = 0x00, MUX2 = 0x01 };
+#define LDR_MUX_CHANNEL_COUNT 16
+// Both MUXs are scanned together, a channel per slot. The ADCs start sampling
+// once the MUX outputs have settled after switching channels, and need 3.4 µs
+// to sample and convert.
+#define LDR_MUX_SETTLE_DELAY 1 // in µs
+#define LDR_SCAN_SLOT_PERIOD 6 // in µs, i.e. a scan every 96 µs
 
+// The defaults below are used until parameters have been calibrated or
+// uploaded by the Teensy and saved to EEPROM (see MUXParameters)
 #define LDR_CALIBRATION_DURATION   10000 // In milliseconds
 #define LDR_CALIBRATION_MULTIPLIER 0.7
+#define LDR_MAX_THRESHOLD          4095 // 12-bit ADC
 
 #define LDR_PIN_COUNT 16 * 2 // The number of possible input pins on the MUXs
 #define LDR_COUNT     30     // The number of actual photodiodes below the robot
@@ -86,6 +101,45 @@ const std::array<uint16_t, LDR_COUNT> LDR_THRESHOLDS = {
     3305, 3209, 3322, 3411, 3062, 3957, 3368, 3946, 3329, 3338,
     3330, 3335, 3318, 3294, 3453, 3226, 3378, 1757, 2971, 2958,
 };
-#define LDR_ACTIVATION_THRESHOLD 3
+// LDRs are on the line once above their thresholds in 2 of the last 3 scans
+// (see ldr_filter.h), so a single noisy scan neither turns one on nor off, but
+// each does so 2 scans (~0.2-0.5 ms, as scans are sent) after it changes
+// rather than 3 as with the old 3 consecutive scans
+#define LDR_FILTER                 LDR_FILTER_K_OF_N
+#define LDR_FILTER_WINDOW          3
+#define LDR_ACTIVATION_THRESHOLD   2
+#define LDR_DEACTIVATION_THRESHOLD 0 // for LDR_FILTER_HYSTERESIS
+// Whether to interpolate the line's edges between LDRs from their intensities
+// (between the field and line values found by calibration) rather than only
+// using which are on the line
+#define LDR_ANALOG_LINE_ESTIMATION 1
+
+// Whether to keep tracking the field and line levels of each LDR during play
+// and move its threshold with them (see adaptLDRLevels())
+#define LDR_ADAPTIVE_THRESHOLDS 1
+// Levels move by 1/2^LDR_LEVEL_SHIFT of the difference of the newest scan's
+// reading from them at most once every LDR_LEVEL_PERIOD (in µs), i.e. with a
+// time constant of 2048 periods (~6 s) however long a scan takes (which depends
+// on the baud rate and payload size, as scans are sent)
+#define LDR_LEVEL_SHIFT  11
+#define LDR_LEVEL_PERIOD 3000
+// Readings further than this many mean absolute deviations from a level only
+// move it as much as ones that far would, so outliers barely move it
+#define LDR_LEVEL_CLIP          3
+#define LDR_LEVEL_MIN_DEVIATION 16  // in ADC counts
+#define LDR_LEVEL_MIN_CONTRAST  256 // between the field and line, in ADC counts
+
+// The line's rates of change are estimated from how fast each of its ends moves
+// (see line_motion.h), over moves of at least LINE_RATE_MIN_STEP (half the
+// spacing of the LDRs, so that every step between them is one), smoothed by
+// LINE_RATE_GAIN (0 to 1, 1 for no smoothing)
+#define LINE_RATE_MIN_STEP 6.0F // in º
+#define LINE_RATE_GAIN     0.5F
+// The robot is only considered to be crossing the line if its size is growing
+// faster than this, in size/s
+#define LINE_MIN_APPROACH_RATE 0.5F
+// An end moving further than this between scans is a different line (or a
+// stray LDR), so its rate starts over
+#define LINE_MAX_END_MOVE 90.0F // in º
 
 #endif
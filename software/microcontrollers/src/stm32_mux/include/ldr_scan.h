@@ -0,0 +1,31 @@
+#ifndef STM32_MUX_LDR_SCAN_H
+#define STM32_MUX_LDR_SCAN_H
+
+#include <array>
+#include <cstdint>
+
+#include "stm32_mux/include/config.h"
+
+// One scan of both LDR MUXs. ADC1 (MUX1) and ADC2 (MUX2) sample the same
+// channel of each at once, and their dual mode packs both results into a word.
+struct LDRFrame {
+    std::array<uint32_t, LDR_MUX_CHANNEL_COUNT> samples;
+
+    // Value of an LDR 0-indexed counting clockwise from 000º
+    uint16_t operator[](const uint8_t index) const {
+        const auto pin = LDR_MAP_REVERSE[index];
+        return samples[pin % LDR_MUX_CHANNEL_COUNT] >>
+               (pin / LDR_MUX_CHANNEL_COUNT * 16);
+    }
+};
+
+// Starts scanning both LDR MUXs in the background. TIM4 steps the select
+// lines through every channel by DMA, triggering a simultaneous conversion on
+// both ADCs once each channel has settled, and the results are DMA'd into one
+// half of a double buffer while the other is read.
+void initLDRScan();
+// Copies the most recently completed scan into frame. Returns false if there
+// has been none since the last call.
+bool readLDRFrame(LDRFrame &frame);
+
+#endif
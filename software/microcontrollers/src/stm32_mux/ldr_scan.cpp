@@ -0,0 +1,163 @@
+#include "stm32_mux/include/ldr_scan.h"
+
+#include <Arduino.h>
+
+// ADC1 and ADC2 sample for 28.5 cycles and convert for 12.5 at 72 MHz / 6
+#define ADC_CLOCK        12    // in MHz
+#define ADC_SAMPLE_TIME  0b011 // SMPx for 28.5 cycles
+#define ADC_CONVERT_TIME 41    // in ADC cycles
+static_assert(LDR_MUX_SETTLE_DELAY * ADC_CLOCK + ADC_CONVERT_TIME <
+                  LDR_SCAN_SLOT_PERIOD * ADC_CLOCK,
+              "Each channel must be converted before the next is selected");
+
+// ADC channels of the MUX outputs
+#define ADC_CHANNEL_LDRMUX1_SIG 8 // PB0
+#define ADC_CHANNEL_LDRMUX2_SIG 9 // PB1
+
+// The BSRR writes (set bits in the low half, reset bits in the high half)
+// TIM4 makes at the end of each slot, selecting the channel of the next
+static std::array<uint32_t, LDR_MUX_CHANNEL_COUNT> selectSequence;
+// Written by DMA from ADC1's data register, which holds both results in dual
+// mode
+static LDRFrame frames[2];
+static volatile uint8_t completedFrame = 0;
+static volatile uint32_t frameCount = 0;
+
+// Returns the BSRR write selecting a channel of an LDR MUX, given its select
+// pins (S0 to S3).
+static uint32_t selectWrite(const std::array<uint32_t, 4> &selectPins,
+                            const uint8_t channel) {
+    uint32_t bsrr = 0;
+    for (uint8_t bit = 0; bit < selectPins.size(); ++bit) {
+        const uint32_t mask = digitalPinToBitMask(selectPins[bit]);
+        bsrr |= (channel >> bit) & 1 ? mask : mask << 16;
+    }
+    return bsrr;
+}
+
+// Sets up the select pins and the BSRR writes selecting each channel of both
+// MUXs at once. Returns the GPIO port of the select pins.
+static GPIO_TypeDef *initSelectPins() {
+    const std::array<uint32_t, 4> mux1Pins = {PIN_LDRMUX1_S0, PIN_LDRMUX1_S1,
+                                              PIN_LDRMUX1_S2, PIN_LDRMUX1_S3};
+    const std::array<uint32_t, 4> mux2Pins = {PIN_LDRMUX2_S0, PIN_LDRMUX2_S1,
+                                              PIN_LDRMUX2_S2, PIN_LDRMUX2_S3};
+    for (const auto pin : mux1Pins) pinMode(pin, OUTPUT);
+    for (const auto pin : mux2Pins) pinMode(pin, OUTPUT);
+
+    std::array<uint32_t, LDR_MUX_CHANNEL_COUNT> writes;
+    for (uint8_t channel = 0; channel < LDR_MUX_CHANNEL_COUNT; ++channel)
+        writes[channel] =
+            selectWrite(mux1Pins, channel) | selectWrite(mux2Pins, channel);
+
+    // Select the first channel now, and each next one at the end of a slot
+    auto *port = digitalPinToPort(PIN_LDRMUX1_S0);
+    port->BSRR = writes[0];
+    for (uint8_t slot = 0; slot < LDR_MUX_CHANNEL_COUNT; ++slot)
+        selectSequence[slot] = writes[(slot + 1) % LDR_MUX_CHANNEL_COUNT];
+    return port;
+}
+
+// Sets up ADC1 (master) and ADC2 (slave) to convert one channel each, at the
+// same time, whenever TIM4_CC4 fires.
+static void initADCs() {
+    pinMode(PIN_LDRMUX1_SIG, INPUT_ANALOG);
+    pinMode(PIN_LDRMUX2_SIG, INPUT_ANALOG);
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_ADCPRE) | RCC_CFGR_ADCPRE_DIV6;
+    RCC->APB2ENR |= RCC_APB2ENR_ADC1EN | RCC_APB2ENR_ADC2EN;
+
+    const auto init = [](ADC_TypeDef *adc, const uint8_t channel) {
+        adc->CR2 = ADC_CR2_ADON;
+        delayMicroseconds(1); // tSTAB
+        adc->CR2 |= ADC_CR2_RSTCAL;
+        while (adc->CR2 & ADC_CR2_RSTCAL) {}
+        adc->CR2 |= ADC_CR2_CAL;
+        while (adc->CR2 & ADC_CR2_CAL) {}
+        adc->SMPR2 = ADC_SAMPLE_TIME << (channel * 3);
+        adc->SQR1 = 0; // one conversion
+        adc->SQR3 = channel;
+    };
+    init(ADC1, ADC_CHANNEL_LDRMUX1_SIG);
+    init(ADC2, ADC_CHANNEL_LDRMUX2_SIG);
+
+    // Regular simultaneous mode, with only the master triggered externally
+    ADC1->CR1 = ADC_CR1_DUALMOD_1 | ADC_CR1_DUALMOD_2;
+    ADC2->CR2 |= ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL; // SWSTART
+    ADC1->CR2 |= ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL_0 | ADC_CR2_EXTSEL_2 |
+                 ADC_CR2_DMA; // TIM4_CC4
+}
+
+// Sets up DMA1 channel 1 to move each pair of results into the double buffer,
+// interrupting as each half completes, and channel 7 to write the select
+// sequence to the select pins on every TIM4 update (USART2 shares channel 7,
+// but the core doesn't use DMA for it).
+static void initDMA(GPIO_TypeDef *port) {
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+
+    DMA1_Channel1->CPAR = (uint32_t)&ADC1->DR;
+    DMA1_Channel1->CMAR = (uint32_t)frames;
+    DMA1_Channel1->CNDTR = 2 * LDR_MUX_CHANNEL_COUNT; // both frames
+    DMA1_Channel1->CCR = DMA_CCR_MSIZE_1 | DMA_CCR_PSIZE_1 | DMA_CCR_MINC |
+                         DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE |
+                         DMA_CCR_EN;
+    NVIC_SetPriority(DMA1_Channel1_IRQn, 0);
+    NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+    DMA1_Channel7->CPAR = (uint32_t)&port->BSRR;
+    DMA1_Channel7->CMAR = (uint32_t)selectSequence.data();
+    DMA1_Channel7->CNDTR = selectSequence.size();
+    DMA1_Channel7->CCR = DMA_CCR_DIR | DMA_CCR_MSIZE_1 | DMA_CCR_PSIZE_1 |
+                         DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_EN;
+}
+
+// Sets up TIM4 to divide time into a slot per channel. CC4 (in PWM mode 2,
+// so OC4REF rises) starts the conversions once the MUXs have settled, and the
+// update at the end of the slot selects the next channel.
+static void initTimer() {
+    RCC->APB1ENR |= RCC_APB1ENR_TIM4EN;
+    // APB1 timers run at the core clock
+    const auto ticksPerMicrosecond = SystemCoreClock / 1000000;
+    TIM4->PSC = 0;
+    TIM4->ARR = LDR_SCAN_SLOT_PERIOD * ticksPerMicrosecond - 1;
+    TIM4->CCR4 = LDR_MUX_SETTLE_DELAY * ticksPerMicrosecond;
+    TIM4->CCMR2 = TIM_CCMR2_OC4M; // PWM mode 2
+    TIM4->CCER = TIM_CCER_CC4E;  // PB9 is left as an input
+    TIM4->DIER = TIM_DIER_UDE;
+    TIM4->CNT = 0;
+    TIM4->CR1 = TIM_CR1_CEN;
+}
+
+void initLDRScan() {
+    auto *port = initSelectPins();
+    initADCs();
+    initDMA(port);
+    initTimer();
+}
+
+// Marks the half of the double buffer that DMA has just finished as the most
+// recent scan.
+extern "C" void DMA1_Channel1_IRQHandler() {
+    const auto flags = DMA1->ISR;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    if (flags & DMA_ISR_TCIF1)
+        completedFrame = 1;
+    else if (flags & DMA_ISR_HTIF1)
+        completedFrame = 0;
+    else
+        return;
+    ++frameCount;
+}
+
+bool readLDRFrame(LDRFrame &frame) {
+    static uint32_t lastFrameCount = 0;
+    uint32_t count;
+    do {
+        count = frameCount;
+        if (count == lastFrameCount) return false;
+        frame = frames[completedFrame];
+        // DMA starts overwriting a frame one scan after completing it, so
+        // copy again if that may have happened meanwhile
+    } while (frameCount != count);
+    lastFrameCount = count;
+    return true;
+}
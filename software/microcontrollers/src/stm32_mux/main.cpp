@@ -1,110 +1,397 @@
 #include <Arduino.h>
+#include <EEPROM.h>
 #include <PacketSerial.h>
+#include <algorithm>
 #include <array>
 
 #include "angle.h"
+#include "framing.h"
+#include "ldr_filter.h"
+#include "line_cluster.h"
+#include "line_motion.h"
+#include "link_test.h"
 #include "shared_config.h"
 #include "stm32_mux/include/config.h"
+#include "stm32_mux/include/ldr_scan.h"
 
 // State
 struct LineData line;
-std::array<uint16_t, LDR_COUNT> activatedCount;
+PacketHeader header;
+// The ends of the line, set by findLine()
+BinaryAngle lineStart, lineEnd;
+LineMotion lineMotion({LINE_RATE_MIN_STEP, LINE_RATE_GAIN,
+                       LINE_MIN_APPROACH_RATE, LINE_MAX_END_MOVE});
+LDRFilter ldrFilter;
+uint32_t activations = 0; // bit i is set if LDR i is on the line
+static_assert(LDR_COUNT == MUX_LDR_COUNT,
+              "LDRData must have a bit for each LDR");
+
+// A level an LDR reads, tracked as a running mean that is robust to outliers
+// (in ADC counts with LDR_LEVEL_SHIFT fraction bits, so that each step moves it
+// until it is within a count of the readings)
+struct LDRLevel {
+    int32_t value;
+    int32_t deviation; // mean absolute deviation
+
+    void reset(const int32_t reading) {
+        value = reading << LDR_LEVEL_SHIFT;
+        deviation = LDR_LEVEL_MIN_DEVIATION << LDR_LEVEL_SHIFT;
+    }
+    // Moves towards a reading, clipping its difference to a few deviations
+    void update(const int32_t reading) {
+        const auto error = (reading << LDR_LEVEL_SHIFT) - value;
+        const auto limit =
+            LDR_LEVEL_CLIP *
+            std::max(deviation, (int32_t)LDR_LEVEL_MIN_DEVIATION
+                                    << LDR_LEVEL_SHIFT);
+        value += constrain(error, -limit, limit) / (1 << LDR_LEVEL_SHIFT);
+        deviation += (abs(error) - deviation) / (1 << LDR_LEVEL_SHIFT);
+    }
+    // In ADC counts
+    int32_t counts() const { return value >> LDR_LEVEL_SHIFT; }
+};
+// The thresholds in use, and with adaptiveThresholds, the levels they are
+// derived from
+std::array<uint16_t, LDR_COUNT> ldrThresholds;
+std::array<LDRLevel, LDR_COUNT> ldrFieldLevels, ldrLineLevels;
+bool ldrLevelsSeeded = false;
+uint32_t ldrLevelsTime = 0; // when they last moved, in µs
+// Bit i is set once LDR i's level has been calibrated or read, rather than
+// assumed from its threshold
+uint32_t ldrFieldsSampled = 0, ldrLinesSampled = 0;
+int16_t thresholdDrift = 0;
+uint8_t thresholdDriftLDR = 0;
+
+// Parameters
+MUXParameters parameters;
+MUXParameters uploadedParameters;
+uint32_t uploadedChunks = 0; // bit i is set once chunk i has been written
+static_assert(sizeof(parameters.ldrThresholds) / sizeof(uint16_t) == LDR_COUNT,
+              "MUXParameters must have one threshold for each LDR");
 
 // Serial
 PacketSerial teensySerial;
+uint32_t corruptFrames = 0;
+uint8_t commandId = 0; // of the last command carried out
+bool commandFailed = false;
+
+// Loads the parameters from EEPROM, or the defaults if none have been saved.
+void loadParameters() {
+    struct {
+        uint16_t magic;
+        MUXParameters parameters;
+        uint16_t crc;
+    } __attribute__((packed)) saved;
+    // Read the whole flash page at once rather than byte by byte
+    eeprom_buffer_fill();
+    for (size_t i = 0; i < sizeof(saved); ++i)
+        ((uint8_t *)&saved)[i] =
+            eeprom_buffered_read_byte(EEPROM_ADDRESS_PARAMETERS + i);
 
-// Sets an LDR MUX to select a specific channel.
-void selectLDRMUXChannel(LDRMUX mux, uint8_t channel) {
-    switch (mux) {
-    case MUX1:
-        digitalWrite(PIN_LDRMUX1_S0, channel & 1);
-        digitalWrite(PIN_LDRMUX1_S1, (channel >> 1) & 1);
-        digitalWrite(PIN_LDRMUX1_S2, (channel >> 2) & 1);
-        digitalWrite(PIN_LDRMUX1_S3, (channel >> 3) & 1);
-    case MUX2:
-        digitalWrite(PIN_LDRMUX2_S0, channel & 1);
-        digitalWrite(PIN_LDRMUX2_S1, (channel >> 1) & 1);
-        digitalWrite(PIN_LDRMUX2_S2, (channel >> 2) & 1);
-        digitalWrite(PIN_LDRMUX2_S3, (channel >> 3) & 1);
+    if (saved.magic == EEPROM_PARAMETERS_MAGIC &&
+        saved.crc == crc16((const uint8_t *)&saved.parameters,
+                           sizeof(saved.parameters))) {
+        parameters = saved.parameters;
+        return;
     }
+    for (uint8_t i = 0; i < LDR_COUNT; ++i)
+        parameters.ldrThresholds[i] = LDR_THRESHOLDS[i];
+    parameters.activationThreshold = LDR_ACTIVATION_THRESHOLD;
+    parameters.calibrationMultiplier = LDR_CALIBRATION_MULTIPLIER;
+    // There are no field and line values until calibrated
+    parameters.analogLineEstimation = LDR_ANALOG_LINE_ESTIMATION;
+    parameters.adaptiveThresholds = LDR_ADAPTIVE_THRESHOLDS;
+    parameters.ldrFilter = LDR_FILTER;
+    parameters.ldrFilterWindow = LDR_FILTER_WINDOW;
+    parameters.deactivationThreshold = LDR_DEACTIVATION_THRESHOLD;
 }
 
-// Reads the value of an LDR 0-indexed counting clockwise from 000º.
-uint16_t readLDR(uint8_t index) {
-    const auto real_index = LDR_MAP_REVERSE[index];
-    selectLDRMUXChannel(real_index < 16 ? MUX1 : MUX2, real_index % 16);
-    return analogRead(real_index < 16 ? PIN_LDRMUX1_SIG : PIN_LDRMUX2_SIG);
+// Starts using the thresholds and filter in the parameters, and adapting the
+// thresholds afresh.
+void resetLDRThresholds() {
+    for (uint8_t i = 0; i < LDR_COUNT; ++i)
+        ldrThresholds[i] = parameters.ldrThresholds[i];
+    ldrFilter.configure(parameters.ldrFilter, parameters.ldrFilterWindow,
+                        parameters.activationThreshold,
+                        parameters.deactivationThreshold);
+    ldrLevelsSeeded = false;
+    thresholdDrift = 0;
+    thresholdDriftLDR = 0;
 }
 
-// Finds the position of the line.
-void findLine() {
-    // Read LDRs, the LDRs need to be activated for a while to reduce noise
+// ADAPTIVE: Tracks the field and line levels of each LDR in a scan (at most
+// once every LDR_LEVEL_PERIOD), and puts its threshold between them as
+// calibration would. Readings above the threshold count towards the line
+// level, and the rest towards the field.
+void adaptLDRLevels(const LDRFrame &frame) {
+    if (!ldrLevelsSeeded) {
+        // Start from the calibrated levels, or without them, assume levels
+        // that put the threshold where calibration would have, until each is
+        // first read
+        ldrFieldsSampled = ldrLinesSampled = 0;
+        for (uint8_t i = 0; i < LDR_COUNT; ++i) {
+            const int32_t threshold = parameters.ldrThresholds[i];
+            auto field = (int32_t)parameters.ldrFieldValues[i];
+            auto line = (int32_t)parameters.ldrLineValues[i];
+            if (line > field) {
+                ldrFieldsSampled |= 1UL << i;
+                ldrLinesSampled |= 1UL << i;
+            } else {
+                field = std::min((int32_t)frame[i],
+                                 threshold - LDR_LEVEL_MIN_CONTRAST / 2);
+                line = field + (threshold - field) /
+                                   std::max(parameters.calibrationMultiplier,
+                                            0.1F);
+            }
+            ldrFieldLevels[i].reset(field);
+            ldrLineLevels[i].reset(line);
+        }
+        ldrLevelsSeeded = true;
+        ldrLevelsTime = micros();
+    } else if (micros() - ldrLevelsTime < LDR_LEVEL_PERIOD) {
+        return;
+    } else {
+        ldrLevelsTime = micros();
+    }
+
+    const int32_t multiplier = parameters.calibrationMultiplier * 256;
+    int16_t maxDrift = 0;
     for (uint8_t i = 0; i < LDR_COUNT; ++i) {
-        if (readLDR(i) > LDR_THRESHOLDS[i]) {
-            if (activatedCount[i] != UINT16_MAX) ++activatedCount[i];
-        } else
-            activatedCount[i] = 0;
+        auto &field = ldrFieldLevels[i];
+        auto &line = ldrLineLevels[i];
+        const auto onLine = frame[i] > ldrThresholds[i];
+        auto &level = onLine ? line : field;
+        auto &sampled = onLine ? ldrLinesSampled : ldrFieldsSampled;
+        // An assumed level is replaced by the first reading of it that the
+        // filtered activations (so far) agree with, rather than by one noisy
+        // reading
+        if (sampled >> i & 1) {
+            level.update(frame[i]);
+        } else if (onLine == (activations >> i & 1)) {
+            level.reset(frame[i]);
+            sampled |= 1UL << i;
+        }
+        // Keep them apart in case the line isn't seen for a long time
+        line.value =
+            std::max(line.value, field.value + (LDR_LEVEL_MIN_CONTRAST
+                                                << LDR_LEVEL_SHIFT));
+
+        const auto threshold =
+            field.counts() +
+            (line.counts() - field.counts()) * multiplier / 256;
+        ldrThresholds[i] = constrain(threshold, 0, LDR_MAX_THRESHOLD);
+
+        // Report the drift from the parameters, e.g. as lighting changes
+        const int16_t drift = ldrThresholds[i] - parameters.ldrThresholds[i];
+        if (abs(drift) > abs(maxDrift)) {
+            maxDrift = drift;
+            thresholdDriftLDR = i;
+        }
     }
+    thresholdDrift = maxDrift;
+}
+
+// Saves the parameters in use to EEPROM.
+void saveParameters() {
+    struct {
+        uint16_t magic;
+        MUXParameters parameters;
+        uint16_t crc;
+    } __attribute__((packed)) saved;
+    saved.magic = EEPROM_PARAMETERS_MAGIC;
+    saved.parameters = parameters;
+    saved.crc = crc16((const uint8_t *)&parameters, sizeof(parameters));
+    // Erase and write the flash page once rather than for every byte
+    eeprom_buffer_fill();
+    for (size_t i = 0; i < sizeof(saved); ++i)
+        eeprom_buffered_write_byte(EEPROM_ADDRESS_PARAMETERS + i,
+                                   ((const uint8_t *)&saved)[i]);
+    eeprom_buffer_flush();
+}
+
+// Writes a chunk of uploaded parameters. Returns false if the chunk is invalid.
+bool writeParameters(const uint8_t offset, const uint8_t *data) {
+    if (offset % MUX_PARAMETER_CHUNK_SIZE != 0 ||
+        offset >= sizeof(uploadedParameters))
+        return false;
+    const auto size = std::min(sizeof(uploadedParameters) - offset,
+                               (size_t)MUX_PARAMETER_CHUNK_SIZE);
+    memcpy((uint8_t *)&uploadedParameters + offset, data, size);
+    uploadedChunks |= 1 << (offset / MUX_PARAMETER_CHUNK_SIZE);
+    return true;
+}
+
+// Applies and saves the uploaded parameters. Returns false if they are
+// incomplete or invalid, in which case the parameters in use are kept.
+bool commitParameters() {
+    const auto chunkCount =
+        (sizeof(uploadedParameters) + MUX_PARAMETER_CHUNK_SIZE - 1) /
+        MUX_PARAMETER_CHUNK_SIZE;
+    const auto complete = uploadedChunks == (1U << chunkCount) - 1;
+    uploadedChunks = 0;
+    if (!complete) return false;
+
+    for (uint8_t i = 0; i < LDR_COUNT; ++i)
+        if (uploadedParameters.ldrThresholds[i] > LDR_MAX_THRESHOLD ||
+            uploadedParameters.ldrFieldValues[i] > LDR_MAX_THRESHOLD ||
+            uploadedParameters.ldrLineValues[i] > LDR_MAX_THRESHOLD)
+            return false;
+    if (uploadedParameters.activationThreshold > UINT8_MAX ||
+        !LDRFilter::valid(uploadedParameters.ldrFilter,
+                          uploadedParameters.ldrFilterWindow,
+                          uploadedParameters.activationThreshold,
+                          uploadedParameters.deactivationThreshold) ||
+        uploadedParameters.analogLineEstimation > 1 ||
+        uploadedParameters.adaptiveThresholds > 1 ||
+        !(uploadedParameters.calibrationMultiplier >= 0 &&
+          uploadedParameters.calibrationMultiplier <= 1))
+        return false;
+
+    parameters = uploadedParameters;
+    saveParameters();
+    resetLDRThresholds();
+    return true;
+}
+
+// Returns how strongly an LDR sees the line, from 0 (field) to 1 (line), or
+// -1 if its field and line values haven't been calibrated (or with
+// adaptiveThresholds, both read yet).
+float lineIntensity(const LDRFrame &frame, const uint8_t index) {
+    if (parameters.adaptiveThresholds &&
+        !((ldrFieldsSampled & ldrLinesSampled) >> index & 1))
+        return -1;
+    const int32_t field = parameters.adaptiveThresholds
+                              ? ldrFieldLevels[index].counts()
+                              : parameters.ldrFieldValues[index];
+    const int32_t line = parameters.adaptiveThresholds
+                             ? ldrLineLevels[index].counts()
+                             : parameters.ldrLineValues[index];
+    if (line <= field) return -1;
+    return constrain((float)(frame[index] - field) / (line - field), 0.0F,
+                     1.0F);
+}
+
+// Moves the angle of a cluster end towards the LDR just outside it, to where
+// the intensity crosses halfway between the two (assuming it changes linearly
+// in between). Returns how confident the edge is, from the contrast between
+// the two LDRs, or -1 if they haven't been calibrated.
+float interpolateEdge(const LDRFrame &frame, const uint8_t end,
+                      const uint8_t outside, BinaryAngle &angle) {
+    const auto endIntensity = lineIntensity(frame, end);
+    const auto outsideIntensity = lineIntensity(frame, outside);
+    if (endIntensity < 0 || outsideIntensity < 0) return -1;
+    const auto contrast = endIntensity - outsideIntensity;
+    if (contrast <= 0) return 0; // the edge can't be placed
+
+    const auto fraction =
+        constrain((endIntensity - 0.5F) / contrast, 0.0F, 1.0F);
+    const auto gap = BinaryAngle::fromDegrees(LDR_BEARINGS[outside]) - angle;
+    angle +=
+        BinaryAngle::fromRaw((int16_t)roundf((int16_t)gap.raw() * fraction));
+    return contrast;
+}
+
+// Finds the position of the line in a scan of the LDRs.
+//
+// LDRs are on the line once ldrFilter has seen them above their thresholds for
+// long enough, and the line is between the two furthest apart.
+// With analogLineEstimation, its edges are then interpolated between these and
+// their neighbours outside the line from their intensities, which is finer
+// than the ~11º between LDRs, and the confidence is how sharp the edges are.
+void findLine(const LDRFrame &frame) {
+    if (parameters.adaptiveThresholds) adaptLDRLevels(frame);
+
+    // The LDRs need to be activated for a while to reduce noise
+    uint32_t hits = 0;
+    for (uint8_t i = 0; i < LDR_COUNT; ++i)
+        if (frame[i] > ldrThresholds[i]) hits |= 1UL << i;
+    activations = ldrFilter.update(hits);
 
     // Get the matches (to the line)
     uint8_t matchCount = 0;
     uint8_t matches[LDR_COUNT];
     for (uint8_t i = 0; i < LDR_COUNT; ++i) {
-        if (activatedCount[i] >= LDR_ACTIVATION_THRESHOLD) {
+        if (activations >> i & 1) {
             matches[matchCount] = i;
             ++matchCount;
         }
     }
 
-    // No match (to the line) was found
-    if (matchCount == 0) {
+    // Find the cluster, i.e. the pair of matches furthest apart (the matches
+    // are in order of bearing, as the LDRs are)
+    uint8_t clusterStart, clusterEnd;
+    if (!findLineCluster(LDR_BEARINGS.data(), matches, matchCount,
+                         clusterStart, clusterEnd)) {
+        // No cluster (or no match to the line at all) was found
         line.angleBisector = NO_LINE_INT16;
         line.size = NO_LINE_UINT8;
+        line.confidence = 0;
         return;
     }
 
-    // Find the cluster
-    float maxAngleDifference = 0;
-    uint8_t clusterStart = LDR_COUNT, clusterEnd = LDR_COUNT;
-    // Iterate through all combinations of matching indices and find
-    // the pair with the greatest minimum difference
-    for (uint8_t i = 0; i < matchCount - 1; ++i) {
-        for (uint8_t j = i + 1; j < matchCount; ++j) {
-            auto angleDifference =
-                fabsf(LDR_BEARINGS[matches[i]] - LDR_BEARINGS[matches[j]]);
-            angleDifference =
-                angleDifference > 180 ? 360 - angleDifference : angleDifference;
-            if (angleDifference > maxAngleDifference) {
-                maxAngleDifference = angleDifference;
-                clusterStart = matches[i];
-                clusterEnd = matches[j];
-            }
+    // Calculate the line angle and size (in binary angles, which wrap around
+    // by themselves)
+    auto clusterStartAngle =
+        BinaryAngle::fromDegrees(LDR_BEARINGS[clusterStart]);
+    auto clusterEndAngle = BinaryAngle::fromDegrees(LDR_BEARINGS[clusterEnd]);
+    line.confidence = 100;
+    if (parameters.analogLineEstimation) {
+        // The LDRs just outside the cluster, going the short way round from
+        // its start to its end
+        const auto clockwise =
+            (int16_t)(clusterEndAngle - clusterStartAngle).raw() >= 0;
+        const auto before = [](uint8_t i) {
+            return (i + LDR_COUNT - 1) % LDR_COUNT;
+        };
+        const auto after = [](uint8_t i) { return (i + 1) % LDR_COUNT; };
+        auto startAngle = clusterStartAngle, endAngle = clusterEndAngle;
+        const auto startConfidence = interpolateEdge(
+            frame, clusterStart,
+            clockwise ? before(clusterStart) : after(clusterStart), startAngle);
+        const auto endConfidence = interpolateEdge(
+            frame, clusterEnd,
+            clockwise ? after(clusterEnd) : before(clusterEnd), endAngle);
+        // Keep to the LDRs if either end hasn't been calibrated
+        if (startConfidence >= 0 && endConfidence >= 0) {
+            clusterStartAngle = startAngle;
+            clusterEndAngle = endAngle;
+            line.confidence =
+                roundf((startConfidence + endConfidence) / 2 * 100);
         }
     }
-
-    // No cluster was found
-    if (clusterStart == LDR_COUNT) {
-        line.angleBisector = NO_LINE_INT16;
-        line.size = NO_LINE_UINT8;
-        return;
-    }
-
-    // Calculate the line angle and size
-    const auto clusterStartAngle = LDR_BEARINGS[clusterStart];
-    const auto clusterEndAngle = LDR_BEARINGS[clusterEnd];
+    const auto clusterDiff = clusterEndAngle - clusterStartAngle;
     const auto clusterMidpoint =
-        bearingMidpoint(clusterStartAngle, clusterEndAngle);
+        clusterStartAngle + BinaryAngle::fromRaw(clusterDiff.raw() / 2);
 
     // Sets lineAngle as perpendicular to angle of the midpoint of cluster ends
-    line.angleBisector = roundf(bearingToAngle(clusterMidpoint) * 100);
+    line.angleBisector = clusterMidpoint.centidegrees();
     // Sets lineSize as the ratio of the cluster size to 180°
-    line.size = roundf(
-        (smallerBearingDiff(clusterStartAngle, clusterEndAngle) / 180.0F) *
-        100);
+    line.size = (clusterDiff.abs().raw() * 100 + 16384) / 32768;
+    lineStart = clusterStartAngle;
+    lineEnd = clusterEndAngle;
 }
 
-// CALIBRATE: Determines threshold values for the photodiodes.
-void printLDRThresholds() {
+// Fills in which LDRs are on the line, and the intensities of the next block
+// of them (quantised to 4 bits), from a scan.
+void fillLDRData(const LDRFrame &frame, LDRData &ldrs) {
+    static uint8_t block = 0;
+    ldrs.activations = activations;
+    ldrs.intensityBlock = block;
+    for (uint8_t i = 0; i < LDR_INTENSITY_BLOCK_SIZE; ++i) {
+        const auto index = block * LDR_INTENSITY_BLOCK_SIZE + i;
+        const auto intensity =
+            index < LDR_COUNT ? lineIntensity(frame, index) : -1;
+        ldrs.setIntensity(i, intensity >= 0
+                                 ? roundf(intensity * LDR_INTENSITY_MAX)
+                                 : NO_LDR_INTENSITY);
+    }
+    block = (block + 1) % ((LDR_COUNT + LDR_INTENSITY_BLOCK_SIZE - 1) /
+                           LDR_INTENSITY_BLOCK_SIZE);
+}
+
+// CALIBRATE: Determines threshold values for the photodiodes, then uses and
+// saves them.
+void calibrateLDRThresholds() {
     // min = green (field), max = white (line)
     uint16_t min[LDR_COUNT], max[LDR_COUNT];
     for (int i = 0; i < LDR_COUNT; ++i) {
@@ -113,43 +400,63 @@ void printLDRThresholds() {
     }
 
     const auto endTime = millis() + LDR_CALIBRATION_DURATION;
+    LDRFrame frame;
     while (millis() < endTime) {
+        if (!readLDRFrame(frame)) continue;
         for (uint8_t i = 0; i < LDR_COUNT; ++i) {
-            const auto value = readLDR(i);
+            const auto value = frame[i];
             if (value < min[i]) min[i] = value;
             if (value > max[i]) max[i] = value;
         }
     }
 
-    // Print the thresholds (averages of min and max)
-    TEENSY_SERIAL.printf("Thresholds: {");
+    // Set the thresholds (between min and max), keeping min and max for
+    // analogLineEstimation
     for (uint8_t i = 0; i < LDR_COUNT; ++i) {
         const auto threshold =
-            (max[i] - min[i]) * LDR_CALIBRATION_MULTIPLIER + min[i];
-        TEENSY_SERIAL.printf("%d, ", (uint16_t)threshold);
+            (max[i] - min[i]) * parameters.calibrationMultiplier + min[i];
+        parameters.ldrThresholds[i] = threshold;
+        parameters.ldrFieldValues[i] = min[i];
+        parameters.ldrLineValues[i] = max[i];
     }
-    TEENSY_SERIAL.printf("}\n");
+    saveParameters();
+    resetLDRThresholds();
+
+#ifdef DEBUG
+    // Print the thresholds, field values and line values
+    DEBUG_SERIAL.printf("Thresholds: {");
+    for (uint8_t i = 0; i < LDR_COUNT; ++i)
+        DEBUG_SERIAL.printf("%d, ", parameters.ldrThresholds[i]);
+    DEBUG_SERIAL.printf("}\nField values: {");
+    for (uint8_t i = 0; i < LDR_COUNT; ++i)
+        DEBUG_SERIAL.printf("%d, ", parameters.ldrFieldValues[i]);
+    DEBUG_SERIAL.printf("}\nLine values: {");
+    for (uint8_t i = 0; i < LDR_COUNT; ++i)
+        DEBUG_SERIAL.printf("%d, ", parameters.ldrLineValues[i]);
+    DEBUG_SERIAL.printf("}\n");
+#endif
 }
 
 // DEBUG: Prints detected line data.
-void printLDR() {
-    findLine();
-
+void printLDR(const LDRFrame &frame) {
     uint16_t values[LDR_COUNT];
-    for (uint8_t i = 0; i < LDR_COUNT; ++i) values[i] = readLDR(i);
+    for (uint8_t i = 0; i < LDR_COUNT; ++i) values[i] = frame[i];
 
     if (line.exists()) {
-        TEENSY_SERIAL.printf("%4d.%02dº %01d.%02d |", line.angleBisector / 100,
+        TEENSY_SERIAL.printf("%4d.%02dº %01d.%02d %3d%% |",
+                             line.angleBisector / 100,
                              abs(line.angleBisector % 100), line.size / 100,
-                             line.size % 100);
+                             line.size % 100, line.confidence);
     } else {
-        TEENSY_SERIAL.printf("              |");
+        TEENSY_SERIAL.printf("                   |");
     }
     for (uint8_t i = 0; i < LDR_COUNT / 2; ++i)
-        TEENSY_SERIAL.printf("%s", values[i] > LDR_THRESHOLDS[i] ? "1" : " ");
+        TEENSY_SERIAL.printf(
+            "%s", values[i] > ldrThresholds[i] ? "1" : " ");
     TEENSY_SERIAL.printf("|");
     for (uint8_t i = LDR_COUNT / 2; i < LDR_COUNT; ++i)
-        TEENSY_SERIAL.printf("%s", values[i] > LDR_THRESHOLDS[i] ? "1" : " ");
+        TEENSY_SERIAL.printf(
+            "%s", values[i] > ldrThresholds[i] ? "1" : " ");
     TEENSY_SERIAL.printf("| ");
     for (uint8_t i = 0; i < LDR_COUNT / 2; ++i)
         TEENSY_SERIAL.printf("%4d ", values[i]);
@@ -161,16 +468,42 @@ void printLDR() {
 
 // ------------------------------ MAIN CODE START ------------------------------
 void onTeensyPacket(const byte *buf, size_t size) {
+    // Answer link tests from the Teensy
+    if (respondToLinkTest(buf, size, TEENSY_SERIAL, teensySerial)) return;
+
+    // Drop corrupted frames
+    const byte *payloadBuf;
+    size_t payloadSize;
+    if (!decodeFrame(buf, size, PAYLOAD_MUX_RX, payloadBuf, payloadSize)) {
+        ++corruptFrames;
+        return;
+    }
+
     MUXRXPayload payload;
     // Don't continue if the payload is invalid
-    if (size != sizeof(payload)) return;
-    memcpy(&payload, buf, sizeof(payload));
+    if (payloadSize != sizeof(payload)) return;
+    memcpy(&payload, payloadBuf, sizeof(payload));
 
-    // If the STM32 is in calibration mode, print the thresholds
-    if (payload.calibrating) { // defaults to false
-        TEENSY_SERIAL.println("Calibrating...");
-        while (1) printLDRThresholds();
+    // Carry out each command once, however many times it is resent
+    if (payload.command == MUX_COMMAND_NONE || payload.commandId == commandId)
+        return;
+    switch (payload.command) {
+    case MUX_COMMAND_CALIBRATE:
+        calibrateLDRThresholds();
+        commandFailed = false;
+        break;
+    case MUX_COMMAND_WRITE_PARAMETERS:
+        commandFailed = !writeParameters(payload.offset, payload.data);
+        break;
+    case MUX_COMMAND_SAVE_PARAMETERS:
+        commandFailed = !commitParameters();
+        break;
+    default:
+        commandFailed = true;
+        break;
     }
+    // Acknowledge the command in the next packets
+    commandId = payload.commandId;
 }
 
 void setup() {
@@ -178,19 +511,12 @@ void setup() {
     pinMode(PIN_LED_DEBUG, OUTPUT);
     digitalWrite(PIN_LED_DEBUG, HIGH);
 
-    // Initialise pins
-    pinMode(PIN_LDRMUX1_S0, OUTPUT);
-    pinMode(PIN_LDRMUX1_S1, OUTPUT);
-    pinMode(PIN_LDRMUX1_S2, OUTPUT);
-    pinMode(PIN_LDRMUX1_S3, OUTPUT);
-    pinMode(PIN_LDRMUX2_S0, OUTPUT);
-    pinMode(PIN_LDRMUX2_S1, OUTPUT);
-    pinMode(PIN_LDRMUX2_S2, OUTPUT);
-    pinMode(PIN_LDRMUX2_S3, OUTPUT);
-    pinMode(PIN_LDRMUX1_SIG, INPUT);
-    pinMode(PIN_LDRMUX2_SIG, INPUT);
+    // Load the thresholds
+    loadParameters();
+    resetLDRThresholds();
 
-    analogReadResolution(12);
+    // Start scanning the LDRs in the background
+    initLDRScan();
 
     // Initialise serial
     TEENSY_SERIAL.begin(TEENSY_MUX_BAUD_RATE);
@@ -212,17 +538,33 @@ void loop() {
     // Read packets from serial
     teensySerial.update();
 
-    // Find the line
-    findLine();
+    // Find the line in each new scan (skipping any missed while sending)
+    LDRFrame frame;
+    if (!readLDRFrame(frame)) return;
+    findLine(frame);
+    header.advance(micros());
+    lineMotion.update(line, lineStart, lineEnd, header.time);
 
     // Send the line data over serial to Teensy
-    byte buf[sizeof(MUXTXPayload)];
-    memcpy(buf, &line, sizeof(line));
-    teensySerial.send(buf, sizeof(buf));
+#ifdef MUX_LDR_DATA
+    MUXLDRTXPayload payload;
+    const auto payloadType = PAYLOAD_MUX_LDR_TX;
+    fillLDRData(frame, payload.ldrs);
+#else
+    MUXTXPayload payload;
+    const auto payloadType = PAYLOAD_MUX_TX;
+#endif
+    payload.header = header;
+    payload.line = line;
+    payload.commandId = commandId;
+    payload.commandFailed = commandFailed;
+    payload.thresholdDrift = thresholdDrift;
+    payload.thresholdDriftLDR = thresholdDriftLDR;
+    sendFrame(teensySerial, payloadType, payload);
 
     // ------------------------------ START DEBUG ------------------------------
     // // Print LDR data
-    // printLDR();
+    // printLDR(frame);
 
     // // Print loop time
     // printLoopTime();
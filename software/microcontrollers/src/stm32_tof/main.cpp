@@ -4,25 +4,40 @@
 #include <Wire.h>
 #include <array>
 
+#include "framing.h"
+#include "link_test.h"
 #include "shared_config.h"
 #include "stm32_tof/include/config.h"
 
 // State
 BoundsData bounds;
 BluetoothPayload bluetoothInboundPayload;
+PacketHeader header;
 
 // Serial managers
 PacketSerial teensySerial;
+uint32_t corruptFrames = 0;
 
 // Time-Of-Flight sensors
 std::array<VL53L1X, TOF_COUNT> tofs;
 
 // ------------------------------ MAIN CODE START ------------------------------
 void onTeensyPacket(const byte *buf, size_t size) {
+    // Answer link tests from the Teensy
+    if (respondToLinkTest(buf, size, TEENSY_SERIAL, teensySerial)) return;
+
+    // Drop corrupted frames
+    const byte *payloadBuf;
+    size_t payloadSize;
+    if (!decodeFrame(buf, size, PAYLOAD_TOF_RX, payloadBuf, payloadSize)) {
+        ++corruptFrames;
+        return;
+    }
+
     TOFRXPayload payload;
     // Don't continue if the payload is invalid
-    if (size != sizeof(payload)) return;
-    memcpy(&payload, buf, sizeof(payload));
+    if (payloadSize != sizeof(payload)) return;
+    memcpy(&payload, payloadBuf, sizeof(payload));
 
     // Send bluetooth outbound payload to HC05
     // TODO: Send data from tofRxPayload.bluetoothOutboundPayload
@@ -108,11 +123,12 @@ void loop() {
     // TODO: Read data into &bluetoothInboundPayload
 
     // Send data over serial to Teensy
-    byte buf[sizeof(TOFTXPayload)];
-    memcpy(buf, &bounds, sizeof(bounds));
-    memcpy(buf + sizeof(bounds), &bluetoothInboundPayload,
-           sizeof(bluetoothInboundPayload));
-    teensySerial.send(buf, sizeof(buf));
+    header.advance(micros());
+    TOFTXPayload payload;
+    payload.header = header;
+    payload.bounds = bounds;
+    payload.bluetoothInboundPayload = bluetoothInboundPayload;
+    sendFrame(teensySerial, PAYLOAD_TOF_TX, payload);
 
     bounds.markAsOld();
 
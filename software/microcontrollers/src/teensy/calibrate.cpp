@@ -8,11 +8,10 @@ void performCalibration() {
 #ifdef CALIBRATE_IMU
     // CALIBRATE IMU
     // Set STM32 IMU to calibration mode
-    const bool calibrating = true;
-    byte buf[sizeof(IMURXPayload)];
-    memcpy(buf, &calibrating, sizeof(calibrating));
+    IMURXPayload payload;
+    payload.calibrating = true;
     // Send 100 times to ensure it gets through
-    for (int i = 0; i < 100; i++) imuSerial.send(buf, sizeof(buf));
+    for (int i = 0; i < 100; i++) sendFrame(imuSerial, PAYLOAD_IMU_RX, payload);
     Serial.println("Calibrating");
 
     movement.velocity = 100;
@@ -37,17 +36,14 @@ void performCalibration() {
 #endif
 #ifdef CALIBRATE_MUX
     // CALIBRATE MUX
-    // Set STM32 MUX to calibration mode
-    const bool calibrating = true;
-    byte buf[sizeof(MUXRXPayload)];
-    memcpy(buf, &calibrating, sizeof(calibrating));
-    // Send 100 times to ensure it gets through
-    for (int i = 0; i < 100; i++) muxSerial.send(buf, sizeof(buf));
-
-    while (1) {
-        // Redirect MUX Serial to monitor
-        while (MUX_SERIAL.available() > 0) Serial.write(MUX_SERIAL.read());
-    }
+    // Have the STM32 MUX find its thresholds, which it then uses and saves
+    Serial.println("Calibrating");
+    MUXRXPayload payload;
+    payload.command = MUX_COMMAND_CALIBRATE;
+    if (sensors.sendMuxCommand(payload, MUX_CALIBRATION_TIMEOUT))
+        Serial.println("Thresholds saved");
+    else
+        Serial.println("Calibration failed");
 #endif
 #ifdef CALIBRATE_ROBOT_ANGLE
     while (1) {
@@ -57,7 +53,8 @@ void performCalibration() {
         // Update heading loop
         updateHeadingLoop();
         if (sensors.robot.angle.newData)
-            movement.headingController.debugPrint("Heading");
+            movement.headingController.sendTelemetry(telemetry,
+                                                     TELEMETRY_PID_HEADING);
 
         // Tune while stationary (rough tuning)
         movement.heading = 0;
@@ -73,6 +70,11 @@ void performCalibration() {
 
         // Actuate outputs
         movement.update();
+
+        // Record and send telemetry without blocking
+        sensors.sendTelemetry(telemetry);
+        movement.sendTelemetry(telemetry);
+        telemetry.drain();
     }
 #endif
 #ifdef CALIBRATE_BALL_CURVE
@@ -88,32 +90,19 @@ void performCalibration() {
             moveBehindBall();
             // Don't go past the line
             avoidLine();
-
-            // Print debug output
-            Serial.print("Ball Distance: ");
-            Serial.print(sensors.ball.value.distance);
-            Serial.print(" | Angle : ");
-            Serial.print(sensors.ball.value.angle);
-            Serial.print(" | Move in ");
-            Serial.print(movement.angle);
-            Serial.print("º at ");
-            Serial.print(movement.velocity);
-            Serial.print(" facing ");
-            Serial.print(movement.heading);
-            Serial.print("º");
-            Serial.println();
-
         } else {
             // Stop if we can't see the ball
             movement.heading = 0;
             movement.setStop();
-
-            // Print debug output
-            Serial.println("Ball not found");
         }
 
         // Actuate outputs
         movement.update();
+
+        // Record and send telemetry without blocking
+        sensors.sendTelemetry(telemetry);
+        movement.sendTelemetry(telemetry);
+        telemetry.drain();
     }
 #endif
 #ifdef CALIBRATE_AVOIDANCE
@@ -138,27 +127,16 @@ void performCalibration() {
         // Don't go past the line
         avoidLine();
 
-        Serial.print("Ball: ");
-        Serial.print(sensors.ball.value.angle);
-        Serial.print("º ");
-        Serial.print(sensors.ball.value.distance);
-        Serial.print(" cm | Line: ");
-        Serial.print(sensors.line.angleBisector);
-        Serial.print("º ");
-        Serial.print(sensors.line.depth);
-        Serial.print(" | Move in ");
-        Serial.print(movement.angle);
-        Serial.print("º at ");
-        Serial.print(movement.velocity);
-        Serial.print(" facing ");
-        Serial.print(movement.heading);
-        Serial.print("º");
-        Serial.println();
-
-        // movement.moveOnLineToBallController.debugPrint("Move to Ball");
+        movement.moveOnLineToBallController.sendTelemetry(
+            telemetry, TELEMETRY_PID_MOVE_ON_LINE_TO_BALL);
 
         // Actuate outputs
         movement.update();
+
+        // Record and send telemetry without blocking
+        sensors.sendTelemetry(telemetry);
+        movement.sendTelemetry(telemetry);
+        telemetry.drain();
     }
 #endif
 #ifdef CALIBRATE_LINE_TRACK
@@ -174,18 +152,16 @@ void performCalibration() {
                               LINE_AVOIDANCE_THRESHOLD / 2, false);
         movement.velocity = 300;
 
-        // Print debug output
-        Serial.print("Move in ");
-        Serial.print(movement.angle);
-        Serial.print("º at ");
-        Serial.print(movement.velocity);
-        Serial.print(" facing ");
-        Serial.print(movement.heading);
-        Serial.print("º ");
-        movement.lineTrackController.debugPrint("Line Track");
+        movement.lineTrackController.sendTelemetry(telemetry,
+                                                   TELEMETRY_PID_LINE_TRACK);
 
         // Actuate outputs
         movement.update();
+
+        // Record and send telemetry without blocking
+        sensors.sendTelemetry(telemetry);
+        movement.sendTelemetry(telemetry);
+        telemetry.drain();
     }
 #endif
 #ifdef CALIBRATE_GOAL_MOVEMENT
@@ -202,31 +178,17 @@ void performCalibration() {
 
             // Don't go past the line
             avoidLine();
-
-            // Print debug output
-            Serial.print("Goal: ");
-            Serial.print(sensors.goals.offensive.distance);
-            Serial.print(" cm at ");
-            Serial.print(sensors.goals.offensive.angle);
-            Serial.print("º | Front TOF: ");
-            Serial.print(sensors.bounds.front.value);
-            Serial.print(" cm | Move in ");
-            Serial.print(movement.angle);
-            Serial.print("º at ");
-            Serial.print(movement.velocity);
-            Serial.print(" facing ");
-            Serial.print(movement.heading);
-            Serial.print("º");
-            Serial.println();
         } else {
             movement.dribble = false;
-
-            // Print debug output
-            Serial.println("Goal not found");
         }
 
         // Actuate outputs
         movement.update();
+
+        // Record and send telemetry without blocking
+        sensors.sendTelemetry(telemetry);
+        movement.sendTelemetry(telemetry);
+        telemetry.drain();
     }
 #endif
 }
\ No newline at end of file
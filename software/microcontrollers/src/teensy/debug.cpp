@@ -61,6 +61,8 @@ void performLoopDebug() {
     // // Line Track
     // TODO
 
+#ifndef TELEMETRY
+    // The same data is sent as binary telemetry instead if TELEMETRY is defined
     if (debugPrintCounter.millisElapsed(100)) {
         // Print debug data
         Serial.printf("Line ");
@@ -80,10 +82,11 @@ void performLoopDebug() {
         if (sensors.robot.position.exists()) {
             Serial.printf(
                 "Position %4d.%02dº %3d.%02d cm | ",
-                (int)sensors.robot.position.value.angle,
-                abs((int)(sensors.robot.position.value.angle * 100) % 100),
-                (int)sensors.robot.position.value.distance,
-                abs((int)(sensors.robot.position.value.distance * 100) % 100));
+                (int)sensors.robot.position.value.angle(),
+                abs((int)(sensors.robot.position.value.angle() * 100) % 100),
+                (int)sensors.robot.position.value.distance(),
+                abs((int)(sensors.robot.position.value.distance() * 100) %
+                    100));
         } else {
             Serial.printf("Position                    | ");
         }
@@ -143,6 +146,7 @@ void performLoopDebug() {
             (int)movement.heading, abs((int)(movement.heading * 100) % 100));
         Serial.println();
     }
+#endif
 
     // // Print loop time
     // printLoopTime();
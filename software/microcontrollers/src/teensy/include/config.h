@@ -23,6 +23,12 @@
 // #define CALIBRATE_LINE_TRACK
 // #define CALIBRATE_GOAL_MOVEMENT
 // #define DISABLE_DRIBBLER
+// #define PROFILE // send 'p' over USB serial to print, 'r' to reset
+// #define TELEMETRY // binary records over USB serial, see tools/telemetry.py
+// #define UPLOAD_MUX_PARAMETERS // see MUX_PARAMETERS
+// #define TEST_LINKS // tests every baud rate of every link at boot
+// #define FLIGHT_RECORDER // send 'd' over USB serial to dump, 'c' to clear
+// ('p' and 'd' print text, so they're left out with TELEMETRY)
 
 // Macro Flags
 #ifdef DEBUG_TEENSY
@@ -114,7 +120,13 @@
 // when compared to this number of previous line angles
 #define LINE_ANGLE_HISTORY 2
 
-#define LIGHTGATE_THRESHOLD 800
+// The lightgate reads lower with the ball in it, and in between these the robot
+// keeps the ball (or lack of it) it had (see lightgate.h)
+#define LIGHTGATE_CAPTURE_THRESHOLD 750
+#define LIGHTGATE_LOSS_THRESHOLD    850
+#define LIGHTGATE_SAMPLE_PERIOD     500 // in µs
+#define LIGHTGATE_DEBOUNCE_SAMPLES  4   // i.e. 2 ms
+#define LIGHTGATE_MAX_EVENTS        8   // queued for the loop
 
 #define TOF_MAX_DISTANCE 70.0F // in cm (at home)
 // #define TOF_MAX_DISTANCE 130.0F // in cm (at computer lab)
@@ -131,6 +143,87 @@
 #define KICKER_ACTIVATION_DURATION 100          // in ms
 #define KICKER_COOLDOWN_DURATION   3000         // in ms
 
+// -------------------------------- Serial Links -------------------------------
+
+// The UARTs are emptied from a timer interrupt every period, in µs (about 5
+// bytes arrive per 50 µs at 1 Mbaud, well within their 64 byte buffers)
+#define SERIAL_LINK_SERVICE_PERIOD 50
+// Size of each link's ring buffer, and how many packets it can hold
+#define SERIAL_LINK_BUFFER_SIZE     1024
+#define SERIAL_LINK_MAX_PACKETS     32
+#define SERIAL_LINK_MAX_PACKET_SIZE 256
+// Packets up to this far behind in the sequence (and sent up to this long
+// before the last, in µs) are considered reordered, anything further means the
+// sender restarted
+#define SERIAL_LINK_REORDER_WINDOW  16
+#define SERIAL_LINK_MAX_REORDER_AGE 100000
+// How fast the estimate of each sender's clock offset can drift upwards, in µs
+// per packet (crystals drift by about 50 ppm)
+#define SERIAL_LINK_CLOCK_LEAK 1
+// A link to an STM32 that has had no packet through for this long (in ms), or
+// this many corrupt frames in a row, is lost (say to the STM32 restarting at
+// LINK_BAUD_RATES[0]) and has its baud rate negotiated again. As that blocks
+// for up to ~0.6 s if the STM32 doesn't answer (with the motors stopped), the
+// wait before the next attempt starts at LINK_LOST_TIMEOUT and doubles after
+// each one until the link is back, up to LINK_LOST_MAX_RETRY_DELAY (in ms)
+#define LINK_LOST_TIMEOUT         500
+#define LINK_LOST_CORRUPT_FRAMES  20
+#define LINK_LOST_MAX_RETRY_DELAY 8000
+
+// Commands to the STM32 MUX are resent until acknowledged, waiting this long
+// for each attempt (in ms)
+#define MUX_COMMAND_TIMEOUT     50
+#define MUX_COMMAND_RETRIES     10
+#define MUX_CALIBRATION_TIMEOUT 15000 // LDR_CALIBRATION_DURATION and then some
+#define MUX_INIT_TIMEOUT        1000  // to first hear from it at all
+
+// ------------------------------ Task Scheduling ------------------------------
+
+// Periods of the tasks run by the scheduler in loop(), in µs
+#define TASK_PERIOD_SERIAL    250
+#define TASK_PERIOD_HEADING   MIN_DT_ROBOT_ANGLE // the controller's fixed dt
+#define TASK_PERIOD_STRATEGY  1000
+#define TASK_PERIOD_MOTORS    1000
+#define TASK_PERIOD_CORAL     10000 // ~3 packets per camera frame
+#define TASK_PERIOD_DEBUG     10000
+#define TASK_PERIOD_COMMANDS  100000
+
+// ------------------------------ MUX Parameters -------------------------------
+
+#ifdef UPLOAD_MUX_PARAMETERS
+// Uploaded to (and saved by) the STM32 MUX on startup, so that it needn't be
+// reflashed for every venue. Thresholds, field values and line values come
+// from CALIBRATE_MUX with DEBUG defined on the STM32 MUX.
+// Home, L1 B
+const MUXParameters MUX_PARAMETERS = {
+    {
+        3182, 3145, 3242, 3081, 3210, 2971, 2927, 3082, 3116, 3294,
+        3305, 3209, 3322, 3411, 3062, 3957, 3368, 3946, 3329, 3338,
+        3330, 3335, 3318, 3294, 3453, 3226, 3378, 1757, 2971, 2958,
+    },
+    2,                 // activation threshold
+    0.7,               // calibration multiplier
+    {},                // field values (uncalibrated, so the line isn't
+                       // interpolated at an LDR until the MUX has read
+                       // both of its levels)
+    {},                // line values
+    1,                 // analog line estimation
+    1,                 // adaptive thresholds
+    LDR_FILTER_K_OF_N, // LDR filter (2 of the last 3 scans)
+    3,                 // LDR filter window
+    0,                 // deactivation threshold
+};
+#endif
+
+// --------------------------------- Telemetry ---------------------------------
+
+// IDs of the PID controllers in telemetry records
+// Keep in sync with tools/telemetry.py!
+#define TELEMETRY_PID_HEADING              0
+#define TELEMETRY_PID_MOVE_TO              1
+#define TELEMETRY_PID_LINE_TRACK           2
+#define TELEMETRY_PID_MOVE_ON_LINE_TO_BALL 3
+
 // ------------------------------- Robot Heading -------------------------------
 
 #define KU_ROBOT_ANGLE 8.0e1F // tuned to ±0.5e1F
@@ -144,6 +237,8 @@
 #define MAX_SETPOINT_CHANGE_ROBOT_ANGLE 0.1F
 #define MIN_DT_ROBOT_ANGLE              5000 // in µs, minimum value for kD to have effect
 #define STATIONARY_SCALER_ROBOT_ANGLE   2.0F
+// Weight of each new reading in the smoothed rate of turn (sent to the Coral)
+#define ROBOT_ANGLE_RATE_GAIN 0.1F
 // Old PID version
 // #define KP_ROBOT_ANGLE 3.6e1F  // tuned to ±0.2e1F
 // #define KI_ROBOT_ANGLE 2.5e-5F // tuned to ±0.5e-5F
@@ -196,6 +291,11 @@
 #define LINE_AVOIDANCE_THRESHOLD        0.4F
 #define LINE_AVOIDANCE_SPEED_MULTIPLIER 2000.0F // TODO: tune
 #define LINE_AVOIDANCE_MAX_SPEED        1023.0F
+// Start avoiding the line before LINE_AVOIDANCE_THRESHOLD if the robot will be
+// over its middle within this long (see Sensors::line.timeToCross)
+#define LINE_AVOIDANCE_TIME_TO_CROSS 0.1F  // in s
+// How far ahead line tracking predicts the line depth
+#define LINE_TRACKING_LOOKAHEAD      0.03F // in s
 
 // Robot won't attempt to curve behind the ball if it's between this and 180º
 #define LINE_TRACKING_NO_CURVE_THRESHOLD 90.0F
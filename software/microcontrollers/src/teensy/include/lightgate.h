@@ -0,0 +1,51 @@
+#ifndef TEENSY_LIGHTGATE_H
+#define TEENSY_LIGHTGATE_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+
+#include "teensy/include/config.h"
+
+// Samples the lightgate from a timer interrupt (a single conversion each, so
+// the loop never waits for the ADC), and debounces whether the robot has the
+// ball with hysteresis. The ball is captured once LIGHTGATE_DEBOUNCE_SAMPLES
+// samples in a row are below LIGHTGATE_CAPTURE_THRESHOLD, and lost once as
+// many are above LIGHTGATE_LOSS_THRESHOLD, i.e. LIGHTGATE_DEBOUNCE_SAMPLES *
+// LIGHTGATE_SAMPLE_PERIOD after it happened. Captures and losses are queued
+// as events for the loop.
+class Lightgate {
+  public:
+    struct Event {
+        uint32_t time; // of the first sample past the threshold, in µs
+        bool hasBall;  // captured, or lost
+    };
+
+    // Call from the interrupt every LIGHTGATE_SAMPLE_PERIOD
+    void sample();
+    // Queues a capture or loss now without sampling, e.g. to replay one
+    void inject(const bool hasBall);
+    // Call from the loop to take the oldest event. Returns false if there are
+    // none.
+    bool nextEvent(Event &event);
+
+    bool hasBall() const { return _hasBall; }
+    // Events dropped because the loop didn't take them in time
+    uint32_t overflows() const { return _overflows; }
+
+  private:
+    void _push(const Event &event);
+
+    // Written by sample() and inject() only
+    volatile bool _hasBall = false;
+    uint8_t _count = 0; // samples in a row past the other threshold
+    Event _pending;     // the first of them
+    std::array<Event, LIGHTGATE_MAX_EVENTS> _events;
+    volatile uint8_t _head = 0;
+    volatile uint32_t _overflows = 0;
+
+    // Written by nextEvent() only
+    volatile uint8_t _tail = 0;
+};
+
+#endif
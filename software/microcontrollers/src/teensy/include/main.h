@@ -1,20 +1,39 @@
 #ifndef MAIN_H
 #define MAIN_H
 
-#include <PacketSerial.h>
-
+#include "scheduler.h"
+#include "telemetry.h"
 #include "teensy/include/movement.h"
 #include "teensy/include/sensors.h"
+#include "teensy/include/serial_link.h"
 
 // Serial
-extern PacketSerial muxSerial;
-extern PacketSerial tofSerial;
-extern PacketSerial imuSerial;
-extern PacketSerial coralSerial;
+extern SerialLink muxSerial;
+extern SerialLink tofSerial;
+extern SerialLink imuSerial;
+extern SerialLink coralSerial;
+void serviceSerialLinks();
 
 // IO
+extern Lightgate lightgate;
+void sampleLightgate();
 extern Sensors sensors;
 extern Movement movement;
+extern Telemetry telemetry;
+#ifdef FLIGHT_RECORDER
+extern FlightRecorder flightRecorder;
+#endif
+
+// Tasks
+extern Scheduler scheduler;
+void serialTask();
+void headingTask();
+void strategyTask();
+void motorTask();
+void coralTask();
+void debugTask();
+void commandTask();
+void idleTask();
 
 // subroutines.cpp
 void updateHeadingLoop();
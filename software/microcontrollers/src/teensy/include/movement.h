@@ -5,6 +5,7 @@
 
 #include "pid.h"
 #include "sensors.h"
+#include "telemetry.h"
 #include "teensy/include/config.h"
 #include "vector.h"
 
@@ -19,11 +20,11 @@ class Movement {
     bool dribble = false;
 
     void init();
-    // Read input
+    // Read input and advance the heading controller
     void updateHeadingController(const float angle);
     // Set parameters in the body of the loop
     void setStop(bool maintainHeading = true);
-    void setMoveTo(const Vector &robot, const Point &destination,
+    void setMoveTo(const CartesianVector &robot, const Point &destination,
                    const float targetHeading);
     void setLineTrack(const float lineDepth, const float targetLineAngle,
                       const float targetLineDepth, const bool trackRightSide);
@@ -38,6 +39,8 @@ class Movement {
     // Call for immediate updates anywhere
     void kick();
 
+    void sendTelemetry(Telemetry &telemetry) const;
+
     // Controllers
     PIDController headingController = PIDController(
         0,                                              // Target angle
@@ -70,6 +73,7 @@ class Movement {
 
     // Internal values
     float _actualHeading = 0;
+    float _angularVelocity = 0;
     // for setMoveTo()
     bool _moveToActive = false;
     Point *_lastDestination = nullptr; // checks if different destination
@@ -1,63 +1,122 @@
 #ifndef TEENSY_SENSORS_H
 #define TEENSY_SENSORS_H
 
-#include <PacketSerial.h>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <deque>
 
+#include "angle.h"
 #include "config.h"
+#include "flight_recorder.h"
+#include "lightgate.h"
+#include "serial_link.h"
 #include "shared_config.h"
+#include "telemetry.h"
 #include "vector.h"
 
-struct Goals {
+// When a reading was taken by its sensor, in µs on the Teensy's clock
+struct Timestamped {
+    uint32_t time = 0;
+
+    uint32_t age() const { return micros() - time; }
+};
+
+struct Goals : Timestamped {
     bool newData = false;
     Vector offensive, defensive;
 };
+struct OtherRobot : BluetoothPayload, Timestamped {
+    OtherRobot &operator=(const BluetoothPayload &payload) {
+        BluetoothPayload::operator=(payload);
+        return *this;
+    }
+};
 
 class Sensors {
   public:
-    Sensors(PacketSerial &muxSerial, PacketSerial &tofSerial,
-            PacketSerial &imuSerial, PacketSerial &coralSerial)
+    Sensors(SerialLink &muxSerial, SerialLink &tofSerial,
+            SerialLink &imuSerial, SerialLink &coralSerial,
+            Lightgate &lightgate)
         : _muxSerial(muxSerial), _tofSerial(tofSerial), _imuSerial(imuSerial),
-          _coralSerial(coralSerial){};
+          _coralSerial(coralSerial), _lightgate(lightgate){};
 
     void init();
+    void negotiateBaudRates();
+    void setFlightRecorder(FlightRecorder *recorder);
     void waitForSubprocessorInit();
 
-    void onMuxPacket(const byte *buffer, size_t size);
-    void onTofPacket(const byte *buffer, size_t size);
-    void onImuPacket(const byte *buffer, size_t size);
-    void onCoralPacket(const byte *buffer, size_t size);
+    void onMuxPacket(const MUXTXPayload &payload);
+    void onMuxLDRPacket(const MUXLDRTXPayload &payload);
+    void onTofPacket(const TOFTXPayload &payload);
+    void onImuPacket(const IMUTXPayload &payload);
+    void onCoralPacket(const CoralTXPayload &payload);
+
+    bool sendMuxCommand(MUXRXPayload payload,
+                        const uint32_t timeout = MUX_COMMAND_TIMEOUT);
+    bool uploadMuxParameters(const MUXParameters &parameters);
 
     void read();
     void markAsRead();
+    // Whether the link to an STM32 was found lost by read(), and
+    // recoverLinks() should be called. That blocks every task for ~0.6 s per
+    // link (longer if the STM32 answers), so stop the motors first.
+    bool linksLost() const { return _linksLost; }
+    void recoverLinks();
+    void printLinkStats(Stream &serial = Serial) const;
+    void resetLinkStats();
+
+    void sendTelemetry(Telemetry &telemetry) const;
 
   private:
     // Write-possible private variables for sensor output
+    //
+    // Angles are BinaryAngle while they're worked out here (offsets, rates and
+    // jumps all wrap around by themselves), and only handed over in º once
+    // wrapped, as the controllers and strategy do their maths in floats.
     struct {
-        struct {
+        struct : Timestamped {
             bool newData = false;
             float value = NAN; // -179.99º to 180.00º
+            float rate = 0;    // in º/s, clockwise
 
             bool established() const { return !std::isnan(value); }
         } angle;
-        struct {
+        struct : Timestamped {
             bool newData = false;
-            Vector value;
+            CartesianVector value; // relative to field center
 
             bool exists() const { return value.exists(); }
         } position;
     } _robot;
-    BluetoothPayload _otherRobot;
-    struct {
+    OtherRobot _otherRobot;
+    struct : Timestamped {
         bool newData = false;
         float angleBisector = NAN; // -179.99º to 180.00º
         float depth = 0;           // 0.00 (inside edge) to 1.00 (outside edge)
+        float confidence = 0;      // 0.00 to 1.00, see findLine() on the MUX
+        float depthRate = 0;       // per s, outwards
+        float angleRate = 0;       // of the bisector, in º/s, clockwise
+        // Until the robot is over the middle of the line on its way out, in s,
+        // or -1 if it isn't heading out (see line_motion.h)
+        float timeToCross = -1;
 
         bool exists() const { return !std::isnan(angleBisector); }
+        // Depth after a while (in s) at the current rate
+        float predictedDepth(const float time) const {
+            return constrain(depth + depthRate * time, 0.0F, 1.0F);
+        }
     } _line;
-    struct {
+    // Only received with MUX_LDR_DATA
+    struct : Timestamped {
+        bool newData = false;
+        uint32_t activations = 0; // bit i is set if LDR i is on the line
+        // 0.00 (field) to 1.00 (line), or -1 until calibrated and received
+        std::array<float, MUX_LDR_COUNT> intensities;
+
+        bool active(uint8_t index) const { return activations >> index & 1; }
+    } _ldrs;
+    struct : Timestamped {
         struct {
             bool newData = false;
             float value = NAN; // 0.0 to TOF_MAX_DISTANCE
@@ -71,31 +130,43 @@ class Sensors {
                    !std::isnan(left.value) && !std::isnan(right.value);
         }
     } _bounds;
-    struct {
+    struct : Timestamped {
         bool newData = false;
         Vector value;
     } _ball;
     Goals _goals;
     bool _hasBall = false; // Assume the robot does not have the ball initially
+    struct : Timestamped { // of the last capture or loss of the ball
+        bool newData = false; // captured or lost since marked as read
+        uint32_t captures = 0;
+        uint32_t losses = 0;
+    } _ballPossession;
 
   public:
     // Read-only public interface to sensor output
     const decltype(_robot) &robot = _robot;
     const decltype(_otherRobot) &otherRobot = _otherRobot;
     const decltype(_line) &line = _line;
+    const decltype(_ldrs) &ldrs = _ldrs;
     const decltype(_bounds) &bounds = _bounds;
     const decltype(_ball) &ball = _ball;
     const decltype(_goals) &goals = _goals;
     const decltype(_hasBall) &hasBall = _hasBall;
+    const decltype(_ballPossession) &ballPossession = _ballPossession;
 
   private:
     void _updateRobotPosition();
+    void _recoverLink(SerialLink &link, HardwareSerial &serial,
+                      const char *name);
 
     // Serial managers to receive packets
-    PacketSerial &_muxSerial;
-    PacketSerial &_tofSerial;
-    PacketSerial &_imuSerial;
-    PacketSerial &_coralSerial;
+    SerialLink &_muxSerial;
+    SerialLink &_tofSerial;
+    SerialLink &_imuSerial;
+    SerialLink &_coralSerial;
+    Lightgate &_lightgate;
+
+    bool _linksLost = false;
 
     // Init flags
     bool _muxInit = false;
@@ -103,14 +174,25 @@ class Sensors {
     bool _imuInit = false;
     bool _coralInit = false;
 
+    FlightRecorder *_flightRecorder = nullptr;
+
+    // Last command carried out by the STM32 MUX
+    uint8_t _muxCommandId = 0;
+    bool _muxCommandFailed = false;
+    // Furthest the MUX has moved an LDR threshold from MUX_PARAMETERS
+    int16_t _muxThresholdDrift = 0;
+    uint8_t _muxThresholdDriftLDR = 0;
+
     // Internal state (robot angle)
-    float _robotAngleOffset;
+    BinaryAngle _robotAngleOffset;
+    BinaryAngle _lastRobotAngle;
 
     // Internal state (line)
     bool _isInside = true;   // Which side of the line is the robot on?
     uint8_t switchCount = 0; // Has the angle jumped consistently enough to
                              // consider the robot to have "switched sides"?
-    std::deque<float> _lineAngleBisectorHistory; // Past angles for comparison
+    std::deque<BinaryAngle>
+        _lineAngleBisectorHistory; // Past angles for comparison
 };
 
 #endif
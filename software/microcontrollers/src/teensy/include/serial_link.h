@@ -0,0 +1,144 @@
+#ifndef TEENSY_SERIAL_LINK_H
+#define TEENSY_SERIAL_LINK_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "flight_recorder.h"
+#include "framing.h"
+#include "shared_config.h"
+#include "teensy/include/config.h"
+
+// A COBS-framed serial link (like PacketSerial) whose UART is serviced from a
+// timer interrupt, so packets are received and timestamped independently of
+// the loop and decoded whenever update() is next called.
+// Packets are expected to be frames (see framing.h) of one payload type, each
+// starting with a PacketHeader. Corrupted, repeated and late packets are
+// dropped before they reach the handler, which is handed the payload in place.
+class SerialLink {
+  public:
+    // Calls a handler with a payload decoded in place
+    typedef void (*PacketRouter)(void *object, const uint8_t *payload);
+
+    struct Stats {
+        uint32_t packets = 0;  // handled
+        uint32_t corrupt = 0;  // failed to decode, or of another type
+        uint32_t drops = 0;    // missing from the sequence
+        uint32_t reorders = 0; // repeated or late, and dropped
+        uint32_t resyncs = 0;  // the sender (probably) restarted
+        uint32_t latency = 0;  // of the last packet, in µs
+        uint32_t maxLatency = 0;
+    };
+
+    // Starts (or with nullptr, stops) servicing a UART, which counts as
+    // hearing from it for lost()
+    void setStream(HardwareSerial *stream);
+    // Routes packets to a member function of object taking the payload, e.g.
+    //   link.setPacketHandler<&Sensors::onMuxPacket>(sensors);
+    // The payload type and size follow from the handler at compile time.
+    template <auto Handler, typename Object>
+    void setPacketHandler(Object &object) {
+        typedef typename HandlerTraits<decltype(Handler)>::Payload Payload;
+        static_assert(sizeof(Payload) + FRAME_OVERHEAD <=
+                          SERIAL_LINK_MAX_PACKET_SIZE,
+                      "payload doesn't fit in a packet");
+        static_assert(
+            std::is_same<decltype(Payload::header), PacketHeader>::value &&
+                offsetof(Payload, header) == 0,
+            "payload doesn't start with a PacketHeader");
+
+        _object = &object;
+        _payloadType = PayloadTypeOf<Payload>::value;
+        _payloadSize = sizeof(Payload);
+        _route = [](void *object, const uint8_t *payload) {
+            (static_cast<Object *>(object)->*Handler)(
+                *reinterpret_cast<const Payload *>(payload));
+        };
+    }
+
+    // Records every frame received (before it is checked) as source
+    void setFlightRecorder(FlightRecorder *recorder, const uint8_t source) {
+        _recorder = recorder;
+        _recorderSource = source;
+    }
+
+    // Call from the interrupt to move received bytes into the ring buffer
+    void service();
+    // Call from the loop to decode and handle every complete packet
+    void update();
+    void send(const uint8_t *buffer, size_t size);
+
+    // When the delimiter of the packet being handled was received, in µs
+    uint32_t packetTime() const { return _packetTime; }
+    // When the data in the packet being handled was read by the sender, in µs
+    // on our clock
+    uint32_t readingTime() const { return _readingTime; }
+    // Bytes dropped because the ring buffer was full
+    uint32_t overflows() const { return _overflows; }
+
+    // Whether no packet has been handled for timeout (in ms), or the last
+    // corruptFrames frames were all corrupt
+    bool lost(const uint32_t timeout, const uint16_t corruptFrames) const;
+    // Whether the link is lost (see LINK_LOST_TIMEOUT) and the sender should
+    // be looked for again, which is at once at first, and then only after a
+    // wait that grows with each attempt until the link is back
+    bool recoveryDue();
+    // Call once the sender has been looked for
+    void recoveryAttempted();
+
+    const Stats &stats() const { return _stats; }
+    void printStats(const char *name, Stream &serial = Serial) const;
+    void resetStats();
+
+  private:
+    template <typename Handler> struct HandlerTraits;
+    template <typename Object, typename Payload_>
+    struct HandlerTraits<void (Object::*)(const Payload_ &)> {
+        typedef Payload_ Payload;
+    };
+
+    bool _accept(const PacketHeader &header);
+
+    HardwareSerial *_stream = nullptr;
+    void *_object = nullptr;
+    uint8_t _payloadType = 0;
+    size_t _payloadSize = 0;
+    PacketRouter _route = nullptr;
+    FlightRecorder *_recorder = nullptr;
+    uint8_t _recorderSource = 0;
+
+    // Written by service() only
+    std::array<uint8_t, SERIAL_LINK_BUFFER_SIZE> _buffer;
+    std::array<uint32_t, SERIAL_LINK_MAX_PACKETS> _delimiterTimes;
+    volatile uint16_t _bufferHead = 0;
+    volatile uint8_t _delimiterHead = 0;
+    bool _discarding = false;
+    volatile uint32_t _overflows = 0;
+
+    // Written by update() only
+    volatile uint16_t _bufferTail = 0;
+    volatile uint8_t _delimiterTail = 0;
+    uint32_t _packetTime = 0;
+    std::array<uint8_t, SERIAL_LINK_MAX_PACKET_SIZE> _packet;
+    size_t _packetSize = 0;
+    bool _packetOverflow = false;
+
+    // Sequence and clock tracking
+    Stats _stats;
+    bool _synced = false;
+    uint16_t _lastSequence = 0;
+    uint32_t _lastSenderTime = 0;
+    uint32_t _clockOffset = 0; // smallest seen arrival - sender time
+    uint32_t _readingTime = 0;
+
+    // Link health
+    uint32_t _lastHeardTime = 0;   // in µs
+    uint16_t _corruptFrames = 0;   // in a row
+    uint32_t _lastAttemptTime = 0; // to recover the link, in µs
+    uint32_t _retryDelay = 0;      // after it, in ms
+};
+
+#endif
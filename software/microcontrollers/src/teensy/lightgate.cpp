@@ -0,0 +1,43 @@
+#include "teensy/include/lightgate.h"
+
+#include <atomic>
+
+// Takes a sample, and queues an event if it settles a capture or loss.
+void Lightgate::sample() {
+    const uint16_t value = analogRead(PIN_LIGHTGATE);
+    const auto pastThreshold = _hasBall ? value > LIGHTGATE_LOSS_THRESHOLD
+                                        : value < LIGHTGATE_CAPTURE_THRESHOLD;
+    if (!pastThreshold) {
+        _count = 0;
+        return;
+    }
+    if (_count == 0) _pending = {micros(), !_hasBall};
+    if (++_count < LIGHTGATE_DEBOUNCE_SAMPLES) return;
+    _push(_pending);
+}
+
+void Lightgate::inject(const bool hasBall) {
+    if (hasBall != _hasBall) _push({micros(), hasBall});
+}
+
+void Lightgate::_push(const Event &event) {
+    _hasBall = event.hasBall;
+    _count = 0;
+    const uint8_t nextHead = (_head + 1) % LIGHTGATE_MAX_EVENTS;
+    if (nextHead == _tail) {
+        ++_overflows;
+        return;
+    }
+    _events[_head] = event;
+    // Publish the event only after it has been written
+    std::atomic_signal_fence(std::memory_order_release);
+    _head = nextHead;
+}
+
+bool Lightgate::nextEvent(Event &event) {
+    if (_tail == _head) return false;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    event = _events[_tail];
+    _tail = (_tail + 1) % LIGHTGATE_MAX_EVENTS;
+    return true;
+}
@@ -1,19 +1,36 @@
 #include <Arduino.h>
-#include <PacketSerial.h>
 
 #include "teensy/include/config.h"
 #include "teensy/include/main.h"
 #include "teensy/include/movement.h"
 #include "teensy/include/sensors.h"
+#include "profiler.h"
 
-PacketSerial muxSerial;
-PacketSerial tofSerial;
-PacketSerial imuSerial;
-PacketSerial coralSerial;
+SerialLink muxSerial;
+SerialLink tofSerial;
+SerialLink imuSerial;
+SerialLink coralSerial;
+IntervalTimer serialLinkTimer;
 
 // IO
-Sensors sensors = Sensors(muxSerial, tofSerial, imuSerial, coralSerial);
+Lightgate lightgate;
+IntervalTimer lightgateTimer;
+Sensors sensors =
+    Sensors(muxSerial, tofSerial, imuSerial, coralSerial, lightgate);
 Movement movement = Movement();
+Telemetry telemetry = Telemetry();
+#ifdef FLIGHT_RECORDER
+DMAMEM uint8_t flightRecorderBuffer[FLIGHT_RECORDER_BUFFER_SIZE];
+FlightRecorder flightRecorder =
+    FlightRecorder(flightRecorderBuffer, sizeof(flightRecorderBuffer));
+#endif
+
+// Tasks
+Scheduler scheduler = Scheduler();
+
+// Profiling
+ProfilerZone strikerZone = ProfilerZone("runStriker");
+ProfilerZone goalieZone = ProfilerZone("runGoalie");
 
 void setup() {
     // Turn on the debug LED
@@ -29,28 +46,43 @@ void setup() {
     Serial.begin(MONITOR_BAUD_RATE);
     Serial.println("Initialising...");
 
+#ifdef PROFILE
+    initProfiler();
+#endif
+
     // Initialise motors and sensors and wait for completion
     movement.init();
     sensors.init();
-#ifndef DEBUG_MUX
-    muxSerial.setPacketHandler(
-        [](const byte *buf, size_t size) { sensors.onMuxPacket(buf, size); });
+#ifdef FLIGHT_RECORDER
+    sensors.setFlightRecorder(&flightRecorder);
+#endif
+#if !defined(DEBUG_MUX) && defined(MUX_LDR_DATA)
+    muxSerial.setPacketHandler<&Sensors::onMuxLDRPacket>(sensors);
+#elif !defined(DEBUG_MUX)
+    muxSerial.setPacketHandler<&Sensors::onMuxPacket>(sensors);
 #endif
 #ifndef DEBUG_TOF
-    tofSerial.setPacketHandler(
-        [](const byte *buf, size_t size) { sensors.onTofPacket(buf, size); });
+    tofSerial.setPacketHandler<&Sensors::onTofPacket>(sensors);
 #endif
 #ifndef DEBUG_IMU
-    imuSerial.setPacketHandler(
-        [](const byte *buf, size_t size) { sensors.onImuPacket(buf, size); });
+    imuSerial.setPacketHandler<&Sensors::onImuPacket>(sensors);
 #endif
 #ifndef DEBUG_CORAL
-    coralSerial.setPacketHandler(
-        [](const byte *buf, size_t size) { sensors.onCoralPacket(buf, size); });
+    coralSerial.setPacketHandler<&Sensors::onCoralPacket>(sensors);
 #endif
+#ifndef DONT_NEGOTIATE_BAUD_RATES
+    sensors.negotiateBaudRates();
+#endif
+    // Receive packets and sample the lightgate in the background from now on
+    serialLinkTimer.begin(serviceSerialLinks, SERIAL_LINK_SERVICE_PERIOD);
+    lightgateTimer.begin(sampleLightgate, LIGHTGATE_SAMPLE_PERIOD);
 #ifndef DONT_WAIT_FOR_SUBPROCESSOR_INIT
     sensors.waitForSubprocessorInit();
 #endif
+#ifdef UPLOAD_MUX_PARAMETERS
+    if (!sensors.uploadMuxParameters(MUX_PARAMETERS))
+        Serial.println("Failed to upload MUX parameters");
+#endif
 
     // Turn off the debug LED
     Serial.println("Initialisation complete");
@@ -60,39 +92,153 @@ void setup() {
     // Runs the corresponding calibration if flag is defined
     performCalibration(); // this would probably be blocking
 #endif
+
+    // The heading controller is advanced at a fixed rate by its task
+    movement.headingController.setFixedDt(TASK_PERIOD_HEADING);
+
+    // Register tasks, in order of priority
+    scheduler.add("serial", serialTask, TASK_PERIOD_SERIAL, 0);
+    scheduler.add("heading", headingTask, TASK_PERIOD_HEADING, 1);
+    scheduler.add("strategy", strategyTask, TASK_PERIOD_STRATEGY, 2);
+    scheduler.add("motors", motorTask, TASK_PERIOD_MOTORS, 3);
+#ifndef DEBUG_CORAL
+    scheduler.add("coral", coralTask, TASK_PERIOD_CORAL, 4);
+#endif
+#ifdef DEBUG
+    scheduler.add("debug", debugTask, TASK_PERIOD_DEBUG, 5);
+#endif
+#if defined(PROFILE) || defined(FLIGHT_RECORDER)
+    scheduler.add("commands", commandTask, TASK_PERIOD_COMMANDS, 6);
+#endif
+    scheduler.setIdleTask(idleTask);
 }
 
-void loop() {
-    // Read all sensor values
+void loop() { scheduler.run(); }
+
+// Moves received bytes out of the UARTs (runs in an interrupt).
+void serviceSerialLinks() {
+    muxSerial.service();
+    tofSerial.service();
+    imuSerial.service();
+    coralSerial.service();
+}
+
+// Samples the lightgate (runs in an interrupt).
+void sampleLightgate() { lightgate.sample(); }
+
+// Reads all sensor values, and finds any STM32 whose link was lost.
+void serialTask() {
     sensors.read();
+    if (sensors.linksLost()) {
+        // Recovering holds every task up, so stop rather than keep driving
+        // blind on the last command meanwhile
+        movement.setStop(false);
+        movement.update();
+        sensors.recoverLinks();
+    }
+}
 
-    // Maintain heading
-    updateHeadingLoop();
+// Maintains heading.
+void headingTask() {
+    if (sensors.robot.angle.established()) {
+        movement.updateHeadingController(sensors.robot.angle.value);
+#ifdef TELEMETRY
+        movement.headingController.sendTelemetry(telemetry,
+                                                 TELEMETRY_PID_HEADING);
+#endif
+    }
+}
 
+// Decides what the robot should do.
+void strategyTask() {
 #ifdef MASTER
     // Performs tasks as the master robot
     if (sensors.otherRobot.masterIsStriker) {
+        PROFILE_SCOPE(strikerZone);
         runStriker();
     } else {
+        PROFILE_SCOPE(goalieZone);
         runGoalie();
     }
 #else
     // Performs tasks as the slave robot
     if (!sensors.otherRobot.masterIsStriker) {
+        PROFILE_SCOPE(strikerZone);
         runStriker();
     } else {
+        PROFILE_SCOPE(goalieZone);
         runGoalie();
     }
 #endif
 
+#ifdef TELEMETRY
+    // Record what the robot saw and decided
+    sensors.sendTelemetry(telemetry);
+    movement.sendTelemetry(telemetry);
+#endif
+
+    // Mark all sensor data as old
+    sensors.markAsRead();
+}
+
+// Actuates outputs.
+void motorTask() { movement.update(); }
+
+// Tells the Coral how the robot is turning and moving, so that it can tell the
+// robot's own motion apart from that of the ball.
+void coralTask() {
+    CoralRXPayload payload;
+    if (sensors.robot.angle.established())
+        payload.setHeading(sensors.robot.angle.value, sensors.robot.angle.rate);
+    payload.setMovement(movement.angle, movement.velocity);
+    sendFrame(coralSerial, PAYLOAD_CORAL_RX, payload);
+}
+
+// Runs any debug code if the corresponding flag is defined.
+void debugTask() {
 #ifdef DEBUG
-    // Runs any debug code if the corresponding flag is defined
     performLoopDebug();
 #endif
+}
 
-    // Actuate outputs
-    movement.update();
+// Handles commands sent over USB serial, i.e. prints or resets the profile,
+// or dumps or clears the flight recorder.
+void commandTask() {
+    while (Serial.available() > 0) {
+        switch (Serial.read()) {
+        // Text printed with TELEMETRY would land in the middle of its binary
+        // records, so only the commands that print nothing are kept then
+#if defined(PROFILE) && !defined(TELEMETRY)
+        case 'p':
+            printProfile();
+            scheduler.printStats();
+            sensors.printLinkStats();
+            break;
+#endif
+#ifdef PROFILE
+        case 'r':
+            resetProfile();
+            scheduler.resetStats();
+            sensors.resetLinkStats();
+            break;
+#endif
+#if defined(FLIGHT_RECORDER) && !defined(TELEMETRY)
+        case 'd':
+            flightRecorder.dump();
+            break;
+#endif
+#ifdef FLIGHT_RECORDER
+        case 'c':
+            flightRecorder.clear();
+            break;
+#endif
+        }
+    }
+}
 
-    // Mark all sensor data as old
-    sensors.markAsRead();
+// Sends buffered telemetry while no task is due.
+void idleTask() {
+#ifdef TELEMETRY
+    telemetry.drain();
+#endif
 }
@@ -0,0 +1,194 @@
+#include "teensy/include/serial_link.h"
+
+#include <Arduino.h>
+#include <PacketSerial.h>
+#include <algorithm>
+#include <atomic>
+
+void SerialLink::setStream(HardwareSerial *stream) {
+    // The interrupt may be servicing the old one
+    noInterrupts();
+    _stream = stream;
+    interrupts();
+    _lastHeardTime = micros();
+    _corruptFrames = 0;
+}
+
+// Moves every byte received by the UART into the ring buffer, timestamping each
+// delimiter. If the buffer fills up, the rest of the packet is dropped and what
+// was kept will fail to decode.
+void SerialLink::service() {
+    if (_stream == nullptr) return;
+
+    while (_stream->available() > 0) {
+        const uint8_t data = _stream->read();
+        const uint16_t nextHead = (_bufferHead + 1) % SERIAL_LINK_BUFFER_SIZE;
+        const bool bufferFull = nextHead == _bufferTail;
+
+        if (data == 0) {
+            const uint8_t nextDelimiterHead =
+                (_delimiterHead + 1) % SERIAL_LINK_MAX_PACKETS;
+            if (bufferFull || nextDelimiterHead == _delimiterTail) {
+                ++_overflows;
+                _discarding = true;
+                continue;
+            }
+            _buffer[_bufferHead] = 0;
+            _delimiterTimes[_delimiterHead] = micros();
+            // Publish the delimiter only after it has been written
+            std::atomic_signal_fence(std::memory_order_release);
+            _delimiterHead = nextDelimiterHead;
+            _bufferHead = nextHead;
+            _discarding = false;
+        } else if (_discarding || bufferFull) {
+            ++_overflows;
+            _discarding = true;
+        } else {
+            _buffer[_bufferHead] = data;
+            std::atomic_signal_fence(std::memory_order_release);
+            _bufferHead = nextHead;
+        }
+    }
+}
+
+// Decodes every complete packet in the ring buffer.
+void SerialLink::update() {
+    // Pick up anything received since the interrupt last ran
+    noInterrupts();
+    service();
+    interrupts();
+
+    const uint16_t head = _bufferHead;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    while (_bufferTail != head) {
+        const uint8_t data = _buffer[_bufferTail];
+        _bufferTail = (_bufferTail + 1) % SERIAL_LINK_BUFFER_SIZE;
+
+        if (data != 0) {
+            if (_packetSize < _packet.size())
+                _packet[_packetSize++] = data;
+            else
+                _packetOverflow = true;
+            continue;
+        }
+
+        // We have reached the end of a packet
+        _packetTime = _delimiterTimes[_delimiterTail];
+        _delimiterTail = (_delimiterTail + 1) % SERIAL_LINK_MAX_PACKETS;
+        if (_route != nullptr && _packetSize > 0 && !_packetOverflow) {
+            uint8_t decoded[SERIAL_LINK_MAX_PACKET_SIZE];
+            const auto size =
+                COBS::decode(_packet.data(), _packetSize, decoded);
+            if (_recorder != nullptr)
+                _recorder->record(_recorderSource, _packetTime, decoded, size);
+            const uint8_t *payload;
+            size_t payloadSize;
+            if (!decodeFrame(decoded, size, _payloadType, payload,
+                             payloadSize) ||
+                payloadSize != _payloadSize) {
+                ++_stats.corrupt;
+                if (_corruptFrames < UINT16_MAX) ++_corruptFrames;
+            } else if (_accept(
+                           *reinterpret_cast<const PacketHeader *>(payload))) {
+                // Payloads are packed and may alias, so they are read in place
+                _route(_object, payload);
+            }
+        }
+        _packetSize = 0;
+        _packetOverflow = false;
+    }
+}
+
+bool SerialLink::lost(const uint32_t timeout,
+                      const uint16_t corruptFrames) const {
+    return micros() - _lastHeardTime >= timeout * 1000 ||
+           _corruptFrames >= corruptFrames;
+}
+
+// The wait applies to a link lost to corrupt frames too, which would otherwise
+// be found lost again a few frames after each attempt.
+bool SerialLink::recoveryDue() {
+    if (!lost(LINK_LOST_TIMEOUT, LINK_LOST_CORRUPT_FRAMES)) {
+        _retryDelay = 0;
+        return false;
+    }
+    return micros() - _lastAttemptTime >= _retryDelay * 1000;
+}
+
+void SerialLink::recoveryAttempted() {
+    _lastAttemptTime = micros();
+    _retryDelay =
+        std::min(std::max(_retryDelay * 2, (uint32_t)LINK_LOST_TIMEOUT),
+                 (uint32_t)LINK_LOST_MAX_RETRY_DELAY);
+}
+
+// Prints the statistics of the link.
+void SerialLink::printStats(const char *name, Stream &serial) const {
+    serial.printf("[%-5s] packets=%8u corrupt=%6u drops=%6u reorders=%6u "
+                  "resyncs=%4u overflows=%6u latency (µs): last=%5u max=%5u\n",
+                  name, _stats.packets, _stats.corrupt, _stats.drops,
+                  _stats.reorders, _stats.resyncs, (uint32_t)_overflows,
+                  _stats.latency, _stats.maxLatency);
+}
+
+void SerialLink::resetStats() {
+    _stats = Stats();
+    _overflows = 0;
+}
+
+// COBS-encodes a packet and writes it with its delimiter.
+void SerialLink::send(const uint8_t *buffer, size_t size) {
+    if (_stream == nullptr || buffer == nullptr || size == 0 ||
+        size > SERIAL_LINK_MAX_PACKET_SIZE)
+        return;
+
+    uint8_t encoded[SERIAL_LINK_MAX_PACKET_SIZE +
+                    SERIAL_LINK_MAX_PACKET_SIZE / 254 + 2];
+    const auto encodedSize = COBS::encode(buffer, size, encoded);
+    encoded[encodedSize] = 0; // delimiter byte
+    _stream->write(encoded, encodedSize + 1);
+}
+
+// Checks the sequence number of a packet and keeps track of the sender's clock.
+// Returns false if the packet should be dropped.
+bool SerialLink::_accept(const PacketHeader &header) {
+    // Forward distance in the sequence and in the sender's clock from the last
+    // packet
+    const auto step = (int16_t)(header.sequence - _lastSequence);
+    const auto elapsed = (int32_t)(header.time - _lastSenderTime);
+    // A sender that restarted starts its sequence and clock over, which can
+    // look like any step in the sequence (even a forward one, once wrapped),
+    // but not one forwards with its clock going backwards or one far back
+    const auto restarted = step <= -SERIAL_LINK_REORDER_WINDOW ||
+                           (step > 0 && elapsed < 0) ||
+                           elapsed < -SERIAL_LINK_MAX_REORDER_AGE;
+    if (!_synced || restarted) {
+        // Start over from this packet without counting drops
+        if (_synced) ++_stats.resyncs;
+        _synced = true;
+        _clockOffset = _packetTime - header.time;
+    } else if (step <= 0) {
+        ++_stats.reorders;
+        return false;
+    } else {
+        _stats.drops += step - 1;
+    }
+    _lastSequence = header.sequence;
+    _lastSenderTime = header.time;
+    _lastHeardTime = _packetTime;
+    _corruptFrames = 0;
+    ++_stats.packets;
+
+    // The packet that took the least time to arrive gives the offset between
+    // the clocks (which slowly leaks upwards to follow drift), and any time
+    // beyond that is latency
+    const auto offset = _packetTime - header.time;
+    if ((int32_t)(offset - _clockOffset) <= 0)
+        _clockOffset = offset;
+    else
+        _clockOffset += SERIAL_LINK_CLOCK_LEAK;
+    _stats.latency = offset - _clockOffset;
+    if (_stats.latency > _stats.maxLatency) _stats.maxLatency = _stats.latency;
+    _readingTime = header.time + _clockOffset;
+    return true;
+}
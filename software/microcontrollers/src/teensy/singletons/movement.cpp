@@ -6,6 +6,9 @@
 #include "angle.h"
 #include "teensy/include/config.h"
 #include "vector.h"
+#include "profiler.h"
+
+ProfilerZone updateZone = ProfilerZone("Movement::update");
 
 Movement::Movement() {}
 
@@ -42,8 +45,17 @@ void Movement::init() {
 #endif
 }
 
+// Advances the heading controller with the robot's current angle. The output
+// is applied on the next update().
 void Movement::updateHeadingController(const float angle) {
     _actualHeading = angle;
+
+    headingController.updateSetpoint(heading);
+    // Scale the controller output linearly to velocity with a reference
+    // velocity of 300 (we tune it at that)
+    auto scaler =
+        velocity == 0 ? STATIONARY_SCALER_ROBOT_ANGLE : (float)velocity / 300;
+    _angularVelocity = headingController.advance(_actualHeading, scaler, true);
 }
 
 void Movement::setStop(bool maintainHeading) {
@@ -58,29 +70,30 @@ void Movement::setStop(bool maintainHeading) {
 
 // Sets the robot to move to a certain cartesian position on the field given the
 // position of the two goals. We are also able to move to a target heading.
-void Movement::setMoveTo(const Vector &robot, const Point &destination,
-                         const float targetHeading) {
-    const auto relativeDestination = -robot + Vector::fromPoint(destination);
+void Movement::setMoveTo(const CartesianVector &robot,
+                         const Point &destination, const float targetHeading) {
+    const auto relativeDestination =
+        CartesianVector::fromPoint(destination) - robot;
 
     // Update move to state
     if (_lastDestination == nullptr || *_lastDestination != destination) {
         // A new move to routine just started
         delete _lastDestination;
         _lastDestination = new Point(destination);
-        _initialDistance = relativeDestination.distance;
+        _initialDistance = relativeDestination.distance();
         moveToController.reset();
     }
 
     // Pack it into instructions for our update function
     _moveToActive = true;
-    angle = relativeDestination.angle;
-    if (relativeDestination.distance > MOVE_TO_PRECISION) {
+    angle = relativeDestination.angle();
+    if (relativeDestination.distance() > MOVE_TO_PRECISION) {
         // The destination hasn't been reached
         // We square the error to make it decelerate linearly
-        const auto controllerError = -powf(relativeDestination.distance, 2);
+        const auto controllerError = -powf(relativeDestination.distance(), 2);
         velocity = moveToController.advance(controllerError);
         heading = (targetHeading - _actualHeading) *
-                  fmin(relativeDestination.distance / _initialDistance, 1.0);
+                  fmin(relativeDestination.distance() / _initialDistance, 1.0);
     } else {
         // The destination has basically been reached
         velocity = 0;
@@ -176,6 +189,8 @@ void Movement::setLinearDecelerate(const int16_t startSpeed,
 
 // Writes the current movement data.
 void Movement::update() {
+    PROFILE_SCOPE(updateZone);
+
     if (_brake) {
         // Stop the motors
         // (I'd like to brake the drivers LOW if implemented in hardware)
@@ -188,23 +203,16 @@ void Movement::update() {
     }
 
     // Convert polar to cartesian
-    const auto x = sinfd(angle);
-    const auto y = cosfd(angle);
+    float x, y;
+    sincosfd(angle, x, y);
 
     // Compute the speeds of the individual motors
     const auto transformSpeed = [this](float velocity_,
                                        float angularComponent) {
         return (int16_t)roundf(velocity_ * velocity + angularComponent);
     };
-    // Find angular component
-    headingController.updateSetpoint(heading);
-    // Scale the controller output linearly to velocity with a reference
-    // velocity of 300 (we tune it at that)
-    auto scaler =
-        velocity == 0 ? STATIONARY_SCALER_ROBOT_ANGLE : (float)velocity / 300;
-    const auto angularVelocity =
-        headingController.advance(_actualHeading, scaler, true);
-    const auto angular = 0.25F * angularVelocity;
+    // Find angular component (from the last updateHeadingController())
+    const auto angular = 0.25F * _angularVelocity;
     // Compute speeds
     const int16_t FLSpeed = transformSpeed(x * COS45 + y * SIN45, angular);
     const int16_t FRSpeed = transformSpeed(x * -COS45 + y * SIN45, -angular);
@@ -275,3 +283,16 @@ void Movement::kick() {
     _kickTime = millis();
     _kickerActivated = true;
 }
+
+// Records the current movement data.
+void Movement::sendTelemetry(Telemetry &telemetry) const {
+    TelemetryMovementRecord record;
+    record.angle = (int16_t)roundf(angle * 100);
+    record.velocity = velocity;
+    record.heading = (int16_t)roundf(heading * 100);
+    record.actualHeading = (int16_t)roundf(_actualHeading * 100);
+    record.angularVelocity = (int16_t)roundf(_angularVelocity);
+    record.dribble = dribble;
+    record.brake = _brake;
+    telemetry.send(record);
+}
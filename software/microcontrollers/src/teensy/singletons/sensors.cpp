@@ -2,12 +2,22 @@
 
 #include <algorithm>
 
+#include "link_test.h"
 #include "shared_config.h"
 #include "teensy/include/config.h"
+#include "profiler.h"
+
+ProfilerZone readZone = ProfilerZone("sensors.read");
+ProfilerZone muxPacketZone = ProfilerZone("onMuxPacket");
+ProfilerZone tofPacketZone = ProfilerZone("onTofPacket");
+ProfilerZone imuPacketZone = ProfilerZone("onImuPacket");
+ProfilerZone coralPacketZone = ProfilerZone("onCoralPacket");
 
 void Sensors::init() {
     analogReadResolution(12);
-    analogReadAveraging(16);
+    // The lightgate is sampled often and debounced rather than averaged
+    analogReadAveraging(1);
+    _ldrs.intensities.fill(-1);
 
     // Initialise serial
     MUX_SERIAL.begin(TEENSY_MUX_BAUD_RATE);
@@ -29,6 +39,85 @@ void Sensors::init() {
 #endif
 }
 
+// Agrees on the fastest reliable baud rate with each STM32. Must be called
+// before the links are serviced.
+void Sensors::negotiateBaudRates() {
+#ifdef TEST_LINKS
+    const bool testAll = true;
+#else
+    const bool testAll = false;
+#endif
+    const auto negotiate = [&](HardwareSerial &serial, const char *name) {
+        Serial.printf("Negotiating baud rate with STM32 %s...\n", name);
+        LinkTestResults results;
+        const auto baudRate = negotiateBaudRate(serial, results, testAll);
+        printLinkTestResults(name, results);
+        if (baudRate == 0)
+            Serial.printf("STM32 %s not found, staying at %u baud\n", name,
+                          LINK_BAUD_RATES[0]);
+        else
+            Serial.printf("STM32 %s at %u baud\n", name, baudRate);
+    };
+#ifndef DEBUG_MUX
+    negotiate(MUX_SERIAL, "MUX");
+#endif
+#ifndef DEBUG_TOF
+    negotiate(TOF_SERIAL, "TOF");
+#endif
+#ifndef DEBUG_IMU
+    negotiate(IMU_SERIAL, "IMU");
+#endif
+}
+
+// Negotiates the baud rate of every link to an STM32 that is lost again, as an
+// STM32 that restarts comes back at LINK_BAUD_RATES[0].
+void Sensors::recoverLinks() {
+#ifndef DONT_NEGOTIATE_BAUD_RATES
+    #ifndef DEBUG_MUX
+    if (_muxSerial.recoveryDue()) _recoverLink(_muxSerial, MUX_SERIAL, "MUX");
+    #endif
+    #ifndef DEBUG_TOF
+    if (_tofSerial.recoveryDue()) _recoverLink(_tofSerial, TOF_SERIAL, "TOF");
+    #endif
+    #ifndef DEBUG_IMU
+    if (_imuSerial.recoveryDue()) _recoverLink(_imuSerial, IMU_SERIAL, "IMU");
+    #endif
+#endif
+    _linksLost = false;
+}
+
+void Sensors::_recoverLink(SerialLink &link, HardwareSerial &serial,
+                           const char *name) {
+    // Keep the interrupt off the UART while the link test has it (which also
+    // restarts the wait for packets)
+    link.setStream(nullptr);
+    LinkTestResults results;
+    const auto baudRate = negotiateBaudRate(serial, results, false, 0);
+    link.setStream(&serial);
+    link.recoveryAttempted();
+
+#ifndef TELEMETRY
+    // Text would land in the middle of the binary records with TELEMETRY
+    Serial.printf("Lost STM32 %s, negotiated baud rate again\n", name);
+    printLinkTestResults(name, results);
+    if (baudRate == 0)
+        Serial.printf("STM32 %s not found\n", name);
+    else
+        Serial.printf("STM32 %s at %u baud\n", name, baudRate);
+#else
+    (void)baudRate;
+#endif
+}
+
+// Records every frame received from now on, and changes of the lightgate.
+void Sensors::setFlightRecorder(FlightRecorder *recorder) {
+    _flightRecorder = recorder;
+    _muxSerial.setFlightRecorder(recorder, FLIGHT_RECORDER_MUX);
+    _tofSerial.setFlightRecorder(recorder, FLIGHT_RECORDER_TOF);
+    _imuSerial.setFlightRecorder(recorder, FLIGHT_RECORDER_IMU);
+    _coralSerial.setFlightRecorder(recorder, FLIGHT_RECORDER_CORAL);
+}
+
 void Sensors::waitForSubprocessorInit() {
     // Initialise subprocessors
 #ifndef DEBUG_MUX
@@ -48,41 +137,94 @@ void Sensors::waitForSubprocessorInit() {
     Serial.println("Waiting for STM32 IMU to initialise...");
     while (!_imuInit) _imuSerial.update();
 #else
-    _robotAngleOffset = 0;
+    _robotAngleOffset = BinaryAngle();
 #endif
 
     // NOTE: We do not wait for the coral here.
 }
 
-void Sensors::onMuxPacket(const byte *buf, size_t size) {
-    // Load payload
-    MUXTXPayload payload;
-    // Don't continue if the payload is invalid
-    if (size != sizeof(payload)) return;
-    memcpy(&payload, buf, sizeof(payload));
+// Sends a command to the STM32 MUX until it is acknowledged. Returns false if
+// it failed or was never acknowledged.
+bool Sensors::sendMuxCommand(MUXRXPayload payload, const uint32_t timeout) {
+    // Wait to hear from the STM32 MUX, so that the command ID is a new one
+    // even if only the Teensy has restarted
+    const auto initStartTime = millis();
+    while (!_muxInit) {
+        if (millis() - initStartTime >= MUX_INIT_TIMEOUT) {
+            Serial.println("STM32 MUX not heard from");
+            return false;
+        }
+        _muxSerial.update();
+    }
+    // 0 means no command has been carried out, so skip it when wrapping
+    payload.commandId = _muxCommandId == UINT8_MAX ? 1 : _muxCommandId + 1;
+
+    for (uint8_t attempt = 0; attempt < MUX_COMMAND_RETRIES; ++attempt) {
+        sendFrame(_muxSerial, PAYLOAD_MUX_RX, payload);
+        const auto startTime = millis();
+        while (millis() - startTime < timeout) {
+            _muxSerial.update();
+            if (_muxCommandId == payload.commandId) return !_muxCommandFailed;
+        }
+    }
+    return false;
+}
 
-    // Update new flag
+// Uploads parameters to the STM32 MUX in chunks, which then uses and saves
+// them. Returns false if the upload failed.
+bool Sensors::uploadMuxParameters(const MUXParameters &parameters) {
+    const auto bytes = (const uint8_t *)&parameters;
+    for (size_t offset = 0; offset < sizeof(parameters);
+         offset += MUX_PARAMETER_CHUNK_SIZE) {
+        MUXRXPayload payload;
+        payload.command = MUX_COMMAND_WRITE_PARAMETERS;
+        payload.offset = offset;
+        memcpy(payload.data, bytes + offset,
+               min(sizeof(parameters) - offset,
+                   (size_t)MUX_PARAMETER_CHUNK_SIZE));
+        if (!sendMuxCommand(payload)) return false;
+    }
+
+    MUXRXPayload payload;
+    payload.command = MUX_COMMAND_SAVE_PARAMETERS;
+    return sendMuxCommand(payload);
+}
+
+void Sensors::onMuxPacket(const MUXTXPayload &payload) {
+    PROFILE_SCOPE(muxPacketZone);
+
+    // Update command acknowledgement
+    _muxCommandId = payload.commandId;
+    _muxCommandFailed = payload.commandFailed;
+    _muxThresholdDrift = payload.thresholdDrift;
+    _muxThresholdDriftLDR = payload.thresholdDriftLDR;
+
+    // Update new flag and time
     _line.newData = payload.line.newData;
+    _line.time = _muxSerial.readingTime();
 
     // Update line angle
-    if (payload.line.angleBisector != NO_LINE_INT16)
-        _line.angleBisector = (float)payload.line.angleBisector / 100;
-    else
-        _line.angleBisector = NAN;
+    const auto lineAngleBisector =
+        BinaryAngle::fromCentidegrees(payload.line.angleBisector);
+    _line.angleBisector =
+        fromWire(payload.line.angleBisector, NO_LINE_INT16, 0.01F);
+    _line.confidence = payload.line.confidence / 100.0F;
+    _line.angleRate = payload.line.angleRate / 10.0F;
 
     // Compute line depth
     if (payload.line.size != NO_LINE_UINT8) {
         // The robot is on the line, proceed to compute line parameters
 
         const auto lineSize = (float)payload.line.size / 100;
-        const auto lineAngleBisector = _line.angleBisector;
+        // The other side of the line
+        const auto flippedLineAngleBisector =
+            (lineAngleBisector + BinaryAngle::fromDegrees(180)).degrees();
 
         // This part records jumps in line angle bisectors by referencing the
         // history by updating switchCount
-        const auto hasJump = [this](float lastAngleBisector) {
-            return smallerBearingDiff(clipBearing(_line.angleBisector),
-                                      clipBearing(lastAngleBisector)) >
-                   LINE_ANGLE_SWITCH_ANGLE;
+        const auto hasJump = [&](BinaryAngle lastAngleBisector) {
+            return (lineAngleBisector - lastAngleBisector).abs() >
+                   BinaryAngle::fromDegrees(LINE_ANGLE_SWITCH_ANGLE);
         };
         if (!_lineAngleBisectorHistory.empty() &&
             std::all_of(_lineAngleBisectorHistory.begin(),
@@ -108,23 +250,30 @@ void Sensors::onMuxPacket(const byte *buf, size_t size) {
             } else {
                 // Robot moved from the outer half to the inner half of the line
                 _line.depth = lineSize / 2;
-                _line.angleBisector = clipAngle(_line.angleBisector + 180);
+                _line.angleBisector = flippedLineAngleBisector;
             }
             _isInside = !_isInside;
 
             // Register the switch
             switchCount = 0;
             _lineAngleBisectorHistory.clear();
-            _lineAngleBisectorHistory.push_back(
-                (float)payload.line.angleBisector / 100);
+            _lineAngleBisectorHistory.push_back(lineAngleBisector);
         } else if (_isInside) {
             // The robot didn't switch sides, on the inner half of the line
             _line.depth = lineSize / 2;
-            _line.angleBisector = clipAngle(_line.angleBisector + 180);
+            _line.angleBisector = flippedLineAngleBisector;
         } else {
             // The robot didn't switch sides, on the outer half of the line
             _line.depth = 1 - lineSize / 2;
         }
+
+        // The line grows as the robot heads towards its middle, i.e. out of
+        // the field on the inner half and back in on the outer half
+        const auto sizeRate = payload.line.sizeRate / 100.0F;
+        _line.depthRate = _isInside ? sizeRate / 2 : -sizeRate / 2;
+        _line.timeToCross = _isInside && payload.line.timeToCross != NO_CROSSING
+                                ? payload.line.timeToCross / 1000.0F
+                                : -1;
     } else {
         // The robot is not on the line
 
@@ -139,78 +288,78 @@ void Sensors::onMuxPacket(const byte *buf, size_t size) {
 
         // Reset the line angle bisector history
         _lineAngleBisectorHistory.clear();
+        _line.depthRate = 0;
+        _line.timeToCross = -1;
     }
 
     // Consider the STM32 MUX to be initialised
     _muxInit = true;
 }
 
-void Sensors::onTofPacket(const byte *buf, size_t size) {
-    // Load payload
-    TOFTXPayload payload;
-    // Don't continue if the payload is invalid
-    if (size != sizeof(payload)) return;
-    memcpy(&payload, buf, sizeof(payload));
+// Handles MUXTXPayload with the LDR data sent instead of it with MUX_LDR_DATA.
+void Sensors::onMuxLDRPacket(const MUXLDRTXPayload &payload) {
+    static_assert(offsetof(MUXLDRTXPayload, ldrs) == sizeof(MUXTXPayload),
+                  "MUXLDRTXPayload must start with a MUXTXPayload");
+
+    _ldrs.newData = true;
+    _ldrs.time = _muxSerial.readingTime();
+    _ldrs.activations = payload.ldrs.activations;
+    for (uint8_t i = 0; i < LDR_INTENSITY_BLOCK_SIZE; ++i) {
+        const auto index =
+            payload.ldrs.intensityBlock * LDR_INTENSITY_BLOCK_SIZE + i;
+        if (index >= MUX_LDR_COUNT) break;
+        const auto intensity = payload.ldrs.intensity(i);
+        _ldrs.intensities[index] =
+            intensity != NO_LDR_INTENSITY
+                ? (float)intensity / LDR_INTENSITY_MAX
+                : -1;
+    }
+
+    onMuxPacket(reinterpret_cast<const MUXTXPayload &>(payload));
+}
+
+void Sensors::onTofPacket(const TOFTXPayload &payload) {
+    PROFILE_SCOPE(tofPacketZone);
 
     // Update bounds data if we have the robot angle
     if (_robot.angle.established()) {
-        _bounds.front.newData = payload.bounds.front.newData;
-        _bounds.back.newData = payload.bounds.back.newData;
-        _bounds.left.newData = payload.bounds.left.newData;
-        _bounds.right.newData = payload.bounds.right.newData;
+        _bounds.time = _tofSerial.readingTime();
+        _bounds.front.newData = payload.bounds.frontNewData;
+        _bounds.back.newData = payload.bounds.backNewData;
+        _bounds.left.newData = payload.bounds.leftNewData;
+        _bounds.right.newData = payload.bounds.rightNewData;
 
         // Calculate bounds, taking into account robot angle
         // TODO: Come up with a more robust way to do this that fits a rectangle
         // to the measured distances
-        if (payload.bounds.front.value == NO_BOUNDS ||
-            payload.bounds.front.value > TOF_MAX_DISTANCE * 10) {
-            _bounds.front.value = NAN;
-        } else {
-            const auto measurement = (float)payload.bounds.front.value / 10;
-            _bounds.front.value =
-                measurement * fabsf(cosfd(_robot.angle.value));
-        }
-        if (payload.bounds.back.value == NO_BOUNDS ||
-            payload.bounds.back.value > TOF_MAX_DISTANCE * 10) {
-            _bounds.back.value = NAN;
-        } else {
-            const auto measurement = (float)payload.bounds.back.value / 10;
-            _bounds.back.value = measurement * fabsf(cosfd(_robot.angle.value));
-        }
-        if (payload.bounds.left.value == NO_BOUNDS ||
-            payload.bounds.left.value > TOF_MAX_DISTANCE * 10) {
-            _bounds.left.value = NAN;
-        } else {
-            const auto measurement = (float)payload.bounds.left.value / 10;
-            _bounds.left.value = measurement * fabsf(cosfd(_robot.angle.value));
-        }
-        if (payload.bounds.right.value == NO_BOUNDS ||
-            payload.bounds.right.value > TOF_MAX_DISTANCE * 10) {
-            _bounds.right.value = NAN;
-        } else {
-            const auto measurement = (float)payload.bounds.right.value / 10;
-            _bounds.right.value =
-                measurement * fabsf(cosfd(_robot.angle.value));
-        }
+        const auto angleCorrection = fabsf(cosfd(_robot.angle.value));
+        const auto bound = [&](uint16_t value) {
+            // Anything beyond the maximum distance is as good as no bound
+            if (value > TOF_MAX_DISTANCE * 10) value = NO_BOUNDS;
+            return fromWire(value, NO_BOUNDS, 0.1F) *
+                   angleCorrection;
+        };
+        _bounds.front.value = bound(payload.bounds.front);
+        _bounds.back.value = bound(payload.bounds.back);
+        _bounds.left.value = bound(payload.bounds.left);
+        _bounds.right.value = bound(payload.bounds.right);
 
         _updateRobotPosition();
     }
 
     // Update bluetooth data
     _otherRobot = payload.bluetoothInboundPayload;
+    _otherRobot.time = _tofSerial.readingTime();
 
     // Consider the STM32 TOF to be initialised
     _tofInit = true;
 }
 
-void Sensors::onImuPacket(const byte *buf, size_t size) {
-    // Load payload
-    IMUTXPayload payload;
-    // Don't continue if the payload is invalid
-    if (size != sizeof(payload)) return;
-    memcpy(&payload, buf, sizeof(payload));
+void Sensors::onImuPacket(const IMUTXPayload &payload) {
+    PROFILE_SCOPE(imuPacketZone);
 
-    const auto robotAngle = (float)payload.imu.robotAngle / 100;
+    const auto robotAngle =
+        BinaryAngle::fromCentidegrees(payload.imu.robotAngle);
     // If this is the first reading, record down the initial angle offset
     if (!_imuInit)
         // We can assume the value has already stabilised as the Teensy can
@@ -218,60 +367,56 @@ void Sensors::onImuPacket(const byte *buf, size_t size) {
         // while
         _robotAngleOffset = robotAngle;
 
-    // Update new flag
+    // Update the (smoothed) rate of turn from the change since the last
+    // reading, which is noisy on its own as readings are only ~1 ms apart
+    const auto lastTime = _robot.angle.time;
+    const auto dt = _imuSerial.readingTime() - lastTime;
+    if (_imuInit && dt > 0) {
+        const auto rate =
+            (robotAngle - _lastRobotAngle).degrees() / ((float)dt * 1e-6F);
+        _robot.angle.rate += (rate - _robot.angle.rate) * ROBOT_ANGLE_RATE_GAIN;
+    }
+    _lastRobotAngle = robotAngle;
+
+    // Update new flag and time
     _robot.angle.newData = payload.imu.newData;
+    _robot.angle.time = _imuSerial.readingTime();
 
-    // Update robot angle
-    _robot.angle.value = clipAngle(robotAngle - _robotAngleOffset);
+    // Update robot angle (the subtraction wraps around by itself, so the
+    // heading controller gets -179.99º to 180.00º however far it has turned)
+    _robot.angle.value = (robotAngle - _robotAngleOffset).degrees();
 
     // Consider the STM32 IMU to be initialised
     _imuInit = true;
 }
 
-void Sensors::onCoralPacket(const byte *buf, size_t size) {
-    // Load payload
-    CoralTXPayload payload;
-    // Don't continue if the payload is invalid
-    if (size != sizeof(payload)) return;
-    memcpy(&payload, buf, sizeof(payload));
+void Sensors::onCoralPacket(const CoralTXPayload &payload) {
+    PROFILE_SCOPE(coralPacketZone);
+
+    const auto vector = [](int16_t angle, uint16_t distance) -> Vector {
+        return {fromWire(angle, NO_BALL_INT16, 0.01F),
+                fromWire(distance, NO_BALL_UINT16, 0.01F)};
+    };
 
     // Update ball data
     _ball.newData = payload.camera.newData;
-    _ball.value = {payload.camera.ballAngle != INT16_MAX
-                       ? (float)payload.camera.ballAngle / 100
-                       : NAN,
-                   payload.camera.ballDistance != UINT16_MAX
-                       ? (float)payload.camera.ballDistance / 100
-                       : NAN};
+    _ball.time = _coralSerial.readingTime();
+    _ball.value =
+        vector(payload.camera.ballAngle, payload.camera.ballDistance);
 
     // Update goal data
     _goals.newData = payload.camera.newData;
+    _goals.time = _coralSerial.readingTime();
+    const auto blueGoal = vector(payload.camera.blueGoalAngle,
+                                 payload.camera.blueGoalDistance);
+    const auto yellowGoal = vector(payload.camera.yellowGoalAngle,
+                                   payload.camera.yellowGoalDistance);
 #if TARGET_BLUE_GOAL
-    _goals.offensive = {payload.camera.blueGoalAngle != INT16_MAX
-                            ? (float)payload.camera.blueGoalAngle / 100
-                            : NAN,
-                        payload.camera.blueGoalDistance != UINT16_MAX
-                            ? (float)payload.camera.blueGoalDistance / 100
-                            : NAN};
-    _goals.defensive = {payload.camera.yellowGoalAngle != INT16_MAX
-                            ? (float)payload.camera.yellowGoalAngle / 100
-                            : NAN,
-                        payload.camera.yellowGoalDistance != UINT16_MAX
-                            ? (float)payload.camera.yellowGoalDistance / 100
-                            : NAN};
+    _goals.offensive = blueGoal;
+    _goals.defensive = yellowGoal;
 #else
-    _goals.offensive = {payload.camera.yellowGoalAngle != INT16_MAX
-                            ? (float)payload.camera.yellowGoalAngle / 100
-                            : NAN,
-                        payload.camera.yellowGoalDistance != UINT16_MAX
-                            ? (float)payload.camera.yellowGoalDistance / 100
-                            : NAN};
-    _goals.defensive = {payload.camera.blueGoalAngle != INT16_MAX
-                            ? (float)payload.camera.blueGoalAngle / 100
-                            : NAN,
-                        payload.camera.blueGoalDistance != UINT16_MAX
-                            ? (float)payload.camera.blueGoalDistance / 100
-                            : NAN};
+    _goals.offensive = yellowGoal;
+    _goals.defensive = blueGoal;
 #endif
 
     _updateRobotPosition();
@@ -281,36 +426,45 @@ void Sensors::onCoralPacket(const byte *buf, size_t size) {
 }
 
 void Sensors::_updateRobotPosition() {
+    // All the vector arithmetic here is done in cartesian form, so the only
+    // trigonometry needed is to convert the goal vectors once
     if (_goals.offensive.exists() && _goals.defensive.exists()) {
         // We can see both goals, so we can perform localisation with that :D
 
         // We use an algorithm that allows us to minimise error propagated by
         // goal distance and rely more on goal angle
+        const CartesianVector offensive = _goals.offensive;
+        const CartesianVector defensive = _goals.defensive;
 
         // Computer a "real" center vector from the two goal vectors
-        const auto fakeCenter = (goals.offensive + goals.defensive) / 2;
+        const auto fakeCenter = (offensive + defensive) / 2;
         const auto scalingFactor =
-            (goals.offensive - fakeCenter).distance / HALF_GOAL_SEPARATION;
+            (offensive - fakeCenter).distance() / HALF_GOAL_SEPARATION;
         const auto realCenter = fakeCenter * scalingFactor;
 
         // Update robot position
         _robot.position.value = -realCenter;
+        _robot.position.time = _goals.time;
     } else if (_goals.offensive.exists()) {
         // Compute a "fake" center vector from the offensive goal vector
-        const Vector realGoalToCenter = {180 - _robot.angle.value,
-                                         HALF_GOAL_SEPARATION};
-        const auto fakeCenter = _goals.offensive + realGoalToCenter;
+        const CartesianVector realGoalToCenter =
+            Vector(180 - _robot.angle.value, HALF_GOAL_SEPARATION);
+        const auto fakeCenter =
+            CartesianVector(_goals.offensive) + realGoalToCenter;
 
         // Update robot position
         _robot.position.value = -fakeCenter;
+        _robot.position.time = _goals.time;
     } else if (_goals.defensive.exists()) {
         // Compute a "fake" center vector from the defensive goal vector
-        const Vector realGoalToCenter = {-_robot.angle.value,
-                                         HALF_GOAL_SEPARATION};
-        const auto fakeCenter = _goals.defensive + realGoalToCenter;
+        const CartesianVector realGoalToCenter =
+            Vector(-_robot.angle.value, HALF_GOAL_SEPARATION);
+        const auto fakeCenter =
+            CartesianVector(_goals.defensive) + realGoalToCenter;
 
         // Update robot position
         _robot.position.value = -fakeCenter;
+        _robot.position.time = _goals.time;
     } else {
         // We can't see any goals, but we might be able to use the TOFs :0
 
@@ -339,7 +493,8 @@ void Sensors::_updateRobotPosition() {
             }
 
             // Update robot position
-            _robot.position.value = Vector::fromPoint({x, y});
+            _robot.position.value = {x, y};
+            _robot.position.time = _bounds.time;
         } else {
             // We can't use the TOFs, so we can't localise :(
             _robot.position.value = {};
@@ -348,18 +503,71 @@ void Sensors::_updateRobotPosition() {
 }
 
 void Sensors::read() {
+    PROFILE_SCOPE(readZone);
+
     // Read packets from serial
     _muxSerial.update();
     _tofSerial.update();
     _imuSerial.update();
     _coralSerial.update();
 
-    // Read lightgate
-    _hasBall = analogRead(PIN_LIGHTGATE) < LIGHTGATE_THRESHOLD;
+#ifndef DONT_NEGOTIATE_BAUD_RATES
+    // Find any STM32 that has restarted, or that the link otherwise lost (each
+    // is checked, as that also ends its wait between attempts once it's back)
+    #ifndef DEBUG_MUX
+    _linksLost |= _muxSerial.recoveryDue();
+    #endif
+    #ifndef DEBUG_TOF
+    _linksLost |= _tofSerial.recoveryDue();
+    #endif
+    #ifndef DEBUG_IMU
+    _linksLost |= _imuSerial.recoveryDue();
+    #endif
+#endif
+
+    // Take the captures and losses of the ball sampled since the last read
+    Lightgate::Event event;
+    while (_lightgate.nextEvent(event)) {
+        _hasBall = event.hasBall;
+        _ballPossession.newData = true;
+        _ballPossession.time = event.time;
+        if (event.hasBall)
+            ++_ballPossession.captures;
+        else
+            ++_ballPossession.losses;
+        // Record the debounced change as it is taken, which keeps the
+        // recording in order and lets replays apply it without debouncing
+        if (_flightRecorder != nullptr) {
+            const uint8_t hasBall = event.hasBall;
+            _flightRecorder->record(FLIGHT_RECORDER_LIGHTGATE, micros(),
+                                    &hasBall, sizeof(hasBall));
+        }
+    }
+}
+
+// Prints the statistics of every serial link.
+void Sensors::printLinkStats(Stream &serial) const {
+    _muxSerial.printStats("mux", serial);
+    serial.printf("[mux  ] LDR threshold drift=%d (LDR %u)\n",
+                  _muxThresholdDrift, _muxThresholdDriftLDR);
+    _tofSerial.printStats("tof", serial);
+    _imuSerial.printStats("imu", serial);
+    _coralSerial.printStats("coral", serial);
+    serial.printf("[lgate] captures=%6u losses=%6u overflows=%6u\n",
+                  _ballPossession.captures, _ballPossession.losses,
+                  _lightgate.overflows());
+}
+
+void Sensors::resetLinkStats() {
+    _muxSerial.resetStats();
+    _tofSerial.resetStats();
+    _imuSerial.resetStats();
+    _coralSerial.resetStats();
 }
 
 void Sensors::markAsRead() {
     _line.newData = false;
+    _ldrs.newData = false;
     _robot.angle.newData = false;
     _robot.position.newData = false;
     _bounds.front.newData = false;
@@ -368,4 +576,47 @@ void Sensors::markAsRead() {
     _bounds.right.newData = false;
     _otherRobot.newData = false;
     _ball.newData = false;
+    _ballPossession.newData = false;
+}
+
+// Records a snapshot of the sensor data.
+void Sensors::sendTelemetry(Telemetry &telemetry) const {
+    const auto toCenti = [](const float value) {
+        return (int16_t)roundf(value * 100);
+    };
+    const auto toDeci = [](const float value) {
+        return (uint16_t)roundf(value * 10);
+    };
+
+    TelemetrySensorsRecord record;
+    if (_robot.angle.established())
+        record.robotAngle = toCenti(_robot.angle.value);
+    if (_robot.position.exists()) {
+        record.robotX = (int16_t)roundf(_robot.position.value.x() * 10);
+        record.robotY = (int16_t)roundf(_robot.position.value.y() * 10);
+    }
+    if (_line.exists()) {
+        record.lineAngleBisector = toCenti(_line.angleBisector);
+        record.lineDepth = (uint8_t)constrain(roundf(_line.depth * 100), 0,
+                                              UINT8_MAX);
+    }
+    if (_bounds.front.valid()) record.boundFront = toDeci(_bounds.front.value);
+    if (_bounds.back.valid()) record.boundBack = toDeci(_bounds.back.value);
+    if (_bounds.left.valid()) record.boundLeft = toDeci(_bounds.left.value);
+    if (_bounds.right.valid()) record.boundRight = toDeci(_bounds.right.value);
+    if (_ball.value.exists()) {
+        record.ballAngle = toCenti(_ball.value.angle);
+        record.ballDistance = toDeci(_ball.value.distance);
+    }
+    if (_goals.offensive.exists()) {
+        record.offensiveGoalAngle = toCenti(_goals.offensive.angle);
+        record.offensiveGoalDistance = toDeci(_goals.offensive.distance);
+    }
+    if (_goals.defensive.exists()) {
+        record.defensiveGoalAngle = toCenti(_goals.defensive.angle);
+        record.defensiveGoalDistance = toDeci(_goals.defensive.distance);
+    }
+    record.hasBall = _hasBall;
+    record.masterIsStriker = _otherRobot.masterIsStriker;
+    telemetry.send(record);
 }
@@ -31,9 +31,8 @@ void runStriker() {
 
     // Write to bluetooth
     // TODO: Update payload accordingly
-    auto bluetoothOutboundPayload =
+    TOFRXPayload payload;
+    payload.bluetoothOutboundPayload =
         BluetoothPayload::create(true, {0, 0}, {0, 0});
-    byte buf[sizeof(TOFRXPayload)];
-    memcpy(buf, &bluetoothOutboundPayload, sizeof(bluetoothOutboundPayload));
-    tofSerial.send(buf, sizeof(buf));
+    sendFrame(tofSerial, PAYLOAD_TOF_RX, payload);
 }
\ No newline at end of file
@@ -104,21 +104,29 @@ void avoidSideWalls() {
 
 void avoidLine() {
     if (sensors.line.exists()) {
-        if (sensors.line.depth > LINE_AVOIDANCE_THRESHOLD) {
+        // Whether the robot will be over the middle of the line soon, in
+        // which case it should start moving away before it gets too far in
+        const auto crossingSoon =
+            sensors.line.timeToCross >= 0 &&
+            sensors.line.timeToCross < LINE_AVOIDANCE_TIME_TO_CROSS;
+        if (sensors.line.depth > LINE_AVOIDANCE_THRESHOLD || crossingSoon) {
             // We're too far into the line, move away quickly
             movement.angle = sensors.line.angleBisector;
-            movement.velocity =
-                fmin(sensors.line.depth * LINE_AVOIDANCE_SPEED_MULTIPLIER,
-                     LINE_AVOIDANCE_MAX_SPEED);
+            movement.velocity = fmin(
+                fmax(sensors.line.depth, LINE_AVOIDANCE_THRESHOLD) *
+                    LINE_AVOIDANCE_SPEED_MULTIPLIER,
+                LINE_AVOIDANCE_MAX_SPEED);
         } else if (sensors.ball.value.exists() && !sensors.hasBall) {
             // We're reasonably within the line, so let's try to line track
-            // towards the ball
+            // towards the ball, correcting for where the line will be by the
+            // time the robot reacts
 
             bool approachingLeftBounds =
                 sensors.bounds.left.value < sensors.bounds.right.value;
-            movement.setMoveOnLineToBall(sensors.line.depth, sensors.ball.value,
-                                         MOVE_ON_LINE_TO_BALL_TARGET_LINE_DEPTH,
-                                         approachingLeftBounds);
+            movement.setMoveOnLineToBall(
+                sensors.line.predictedDepth(LINE_TRACKING_LOOKAHEAD),
+                sensors.ball.value, MOVE_ON_LINE_TO_BALL_TARGET_LINE_DEPTH,
+                approachingLeftBounds);
         }
     } else if (!sensors.hasBall) {
         // Start line tracking a bit earlier within a TOF threshold near line
@@ -0,0 +1,56 @@
+#include "telemetry.h"
+
+#include <Arduino.h>
+#include <PacketSerial.h>
+#include <algorithm>
+
+// Frames and buffers a record. Returns false (and drops the record) if the
+// buffer is too full.
+bool Telemetry::push(const uint8_t type, const uint8_t *record,
+                     const size_t size) {
+    if (size > TELEMETRY_MAX_RECORD_SIZE) return false;
+
+    // Frame record
+    byte frame[sizeof(TelemetryHeader) + TELEMETRY_MAX_RECORD_SIZE];
+    const TelemetryHeader header = {type, micros()};
+    memcpy(frame, &header, sizeof(header));
+    memcpy(frame + sizeof(header), record, size);
+
+    // Encode frame
+    byte encoded[sizeof(frame) + sizeof(frame) / 254 + 2];
+    const auto encodedSize =
+        COBS::encode(frame, sizeof(header) + size, encoded);
+    encoded[encodedSize] = 0; // delimiter byte
+
+    // Drop whole frames so that the stream never has partial ones
+    if (encodedSize + 1 > TELEMETRY_BUFFER_SIZE - 1 - buffered()) {
+        ++_dropped;
+        return false;
+    }
+    for (size_t i = 0; i <= encodedSize; ++i) {
+        _buffer[_head] = encoded[i];
+        _head = (_head + 1) % TELEMETRY_BUFFER_SIZE;
+    }
+    return true;
+}
+
+// Returns the number of bytes written.
+size_t Telemetry::drain(Stream &serial) {
+    size_t written = 0;
+    while (_tail != _head) {
+        const auto available = serial.availableForWrite();
+        if (available <= 0) break;
+
+        // Write the contiguous part of the buffer
+        const auto end = _head > _tail ? _head : TELEMETRY_BUFFER_SIZE;
+        const auto size = std::min(end - _tail, (size_t)available);
+        serial.write(&_buffer[_tail], size);
+        _tail = (_tail + size) % TELEMETRY_BUFFER_SIZE;
+        written += size;
+    }
+    return written;
+}
+
+size_t Telemetry::buffered() const {
+    return (_head + TELEMETRY_BUFFER_SIZE - _tail) % TELEMETRY_BUFFER_SIZE;
+}
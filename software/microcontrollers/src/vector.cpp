@@ -20,16 +20,22 @@ Vector &Vector::operator=(const Vector &other) {
 }
 
 Vector Vector::operator+(const Vector &other) const {
-    float x = distance * cosfd(angle) + other.distance * cosfd(other.angle);
-    float y = distance * sinfd(angle) + other.distance * sinfd(other.angle);
+    float sine, cosine, otherSine, otherCosine;
+    sincosfd(angle, sine, cosine);
+    sincosfd(other.angle, otherSine, otherCosine);
+    float x = distance * sine + other.distance * otherSine;
+    float y = distance * cosine + other.distance * otherCosine;
     return {atan2fd(x, y), sqrtf(x * x + y * y)};
 }
 
 Vector Vector::operator-() const { return {clipAngle(angle + 180), distance}; }
 
 Vector Vector::operator-(const Vector &other) const {
-    float x = distance * cosfd(angle) - other.distance * cosfd(other.angle);
-    float y = distance * sinfd(angle) - other.distance * sinfd(other.angle);
+    float sine, cosine, otherSine, otherCosine;
+    sincosfd(angle, sine, cosine);
+    sincosfd(other.angle, otherSine, otherCosine);
+    float x = distance * sine - other.distance * otherSine;
+    float y = distance * cosine - other.distance * otherCosine;
     return {atan2fd(x, y), sqrtf(x * x + y * y)};
 }
 
@@ -40,3 +46,33 @@ Vector Vector::operator*(const float other) const {
 Vector Vector::operator/(const float other) const {
     return {angle, distance / other};
 }
+
+CartesianVector::CartesianVector(const Vector &vector) {
+    float sine, cosine;
+    sincosfd(vector.angle, sine, cosine);
+    _x = vector.distance * sine;
+    _y = vector.distance * cosine;
+
+    // We already know the polar form if it is in the canonical range
+    if (vector.distance >= 0 && vector.angle > -180 && vector.angle <= 180) {
+        _hasAngle = _hasDistance = true;
+        _angle = vector.angle;
+        _distance = vector.distance;
+    }
+}
+
+float CartesianVector::angle() const {
+    if (!_hasAngle) {
+        _angle = atan2fd(_x, _y);
+        _hasAngle = true;
+    }
+    return _angle;
+}
+
+float CartesianVector::distance() const {
+    if (!_hasDistance) {
+        _distance = sqrtf(_x * _x + _y * _y);
+        _hasDistance = true;
+    }
+    return _distance;
+}
\ No newline at end of file
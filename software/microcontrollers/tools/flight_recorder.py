@@ -0,0 +1,101 @@
+"""Dumps the Teensy's flight recorder (see include/flight_recorder.h) to a file.
+
+Usage:
+    python3 flight_recorder.py /dev/ttyACM0 match.bin          # dump
+    python3 flight_recorder.py /dev/ttyACM0 match.bin --clear  # dump, clear
+
+The dump can then be replayed through the Teensy code on the host with
+.pio/build/native/program replay match.bin match.csv
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+from cobs import cobs
+from serial import Serial
+
+
+# Keep in sync with include/flight_recorder.h!
+HEADER = struct.Struct("<BIH")  # source, time (µs), size
+SOURCES = {0: "mux", 1: "tof", 2: "imu", 3: "coral", 4: "lightgate"}
+END = 0xFF
+
+DUMP_TIMEOUT = 5  # in s, without any bytes received
+
+
+def parse_entry(frame: bytes):
+    """Returns the header of an encoded entry, or None if it isn't one."""
+    try:
+        entry = cobs.decode(frame)
+    except cobs.DecodeError:
+        return None
+    if len(entry) < HEADER.size:
+        return None
+    source, time_, size = HEADER.unpack_from(entry)
+    if len(entry) != HEADER.size + size:
+        return None
+    return source, time_, size
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("device", help="serial device of the Teensy")
+    parser.add_argument("output", help="file to write the dump to")
+    parser.add_argument(
+        "--clear", action="store_true", help="clear the recorder afterwards"
+    )
+    args = parser.parse_args()
+
+    serial = Serial(args.device, timeout=0.1)
+    serial.reset_input_buffer()
+    serial.write(b"d")
+
+    counts = {name: 0 for name in SOURCES.values()}
+    first_time = last_time = None
+    invalid = 0
+    ended = False
+    buffer = bytearray()
+    last_receive_time = time.monotonic()
+    with open(args.output, "wb") as file:
+        while not ended:
+            data = serial.read(max(1, serial.in_waiting))
+            if data:
+                last_receive_time = time.monotonic()
+            elif time.monotonic() - last_receive_time > DUMP_TIMEOUT:
+                print("Timed out before the end of the dump", file=sys.stderr)
+                break
+
+            buffer += data
+            *frames, buffer = buffer.split(b"\x00")
+            for frame in frames:
+                # Drop anything that isn't an entry, e.g. text printed by the
+                # Teensy before the dump started
+                header = parse_entry(bytes(frame)) if frame else None
+                if header is None:
+                    invalid += int(bool(frame))
+                    continue
+                file.write(bytes(frame) + b"\x00")
+                source, time_, _ = header
+                if source == END:
+                    ended = True
+                    break
+                name = SOURCES.get(source, "unknown")
+                counts[name] = counts.get(name, 0) + 1
+                first_time = time_ if first_time is None else first_time
+                last_time = time_
+
+    if args.clear and ended:
+        serial.write(b"c")
+
+    span = (last_time - first_time) % 2**32 / 1e6 if first_time is not None else 0
+    print(
+        ", ".join(f"{count} {name}" for name, count in counts.items())
+        + f" entries over {span:.1f} s, {invalid} invalid frames",
+        file=sys.stderr,
+    )
+
+
+if __name__ == "__main__":
+    main()
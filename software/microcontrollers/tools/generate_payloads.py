@@ -0,0 +1,358 @@
+#!/usr/bin/env python3
+"""Generates the packed payload structs for C++ and Python from payloads.py.
+
+Usage: python3 tools/generate_payloads.py [--check]
+
+With --check, nothing is written and the exit status is 1 if the generated
+files are out of date.
+"""
+import math
+import re
+import struct
+import sys
+from pathlib import Path
+
+import payloads
+
+TOOLS = Path(__file__).resolve().parent
+CPP_PATH = TOOLS.parent / "include" / "payloads.h"
+PYTHON_PATH = TOOLS.parents[1] / "coral" / "server" / "camera" / "payloads.py"
+
+# type: (C++ type, struct format)
+PRIMITIVES = {
+    "int8": ("int8_t", "b"),
+    "uint8": ("uint8_t", "B"),
+    "int16": ("int16_t", "h"),
+    "uint16": ("uint16_t", "H"),
+    "int32": ("int32_t", "i"),
+    "uint32": ("uint32_t", "I"),
+    "float": ("float", "f"),
+}
+
+STRUCTS = {name: (comment, fields, methods)
+           for name, comment, fields, methods in payloads.STRUCTS}
+
+
+def snake_case(name):
+    return re.sub(r"(?<!^)(?=[A-Z][a-z])|(?<=[a-z0-9])(?=[A-Z])", "_",
+                  name).lower()
+
+
+def array(kind):
+    """Splits an array type like "uint16[30]" into its element type, its length
+    as written and its length, or returns None if it is not an array."""
+    match = re.fullmatch(r"(\w+)\[(\w+)\]", kind)
+    if match is None:
+        return None
+    element, length = match.groups()
+    constants = {name: value for name, _, value in payloads.CONSTANTS}
+    return element, length, constants.get(length) or int(length)
+
+
+def groups(fields):
+    """Splits fields into lists of consecutive flags and single fields."""
+    result = []
+    for field in fields:
+        if field[1] == "flag" and result and result[-1][0][1] == "flag" \
+                and len(result[-1]) < 8:
+            result[-1].append(field)
+        else:
+            result.append([field])
+    return result
+
+
+def struct_format(name):
+    """Returns the struct format of a struct, without the byte order."""
+    _, fields, _ = STRUCTS[name]
+    fmt = ""
+    for group in groups(fields):
+        kind = group[0][1]
+        if kind == "flag":
+            fmt += "B"
+        elif array(kind):
+            element, _, length = array(kind)
+            fmt += f"{length}{PRIMITIVES[element][1]}"
+        elif kind in PRIMITIVES:
+            fmt += PRIMITIVES[kind][1]
+        else:
+            fmt += struct_format(kind)
+    return fmt
+
+
+def struct_size(name):
+    return struct.calcsize("<" + struct_format(name))
+
+
+def cpp_value(value):
+    if isinstance(value, bool):
+        return "true" if value else "false"
+    if isinstance(value, float) and math.isnan(value):
+        return "NAN"
+    return str(value)
+
+
+def python_value(value):
+    if isinstance(value, float) and math.isnan(value):
+        return 'float("nan")'
+    return str(value)
+
+
+def align_comments(lines):
+    """Aligns the trailing comments of consecutive lines like clang-format."""
+    result = []
+    block = []
+
+    def flush():
+        width = max((len(code) for code, _ in block), default=0)
+        for code, comment in block:
+            result.append(f"{code.ljust(width)} // {comment}")
+        block.clear()
+
+    for code, comment in lines:
+        if comment is None:
+            flush()
+            result.append(code)
+        else:
+            block.append((code, comment))
+    flush()
+    return result
+
+
+def wrap(text, first, rest, width=80):
+    """Word-wraps text, starting lines with first and then rest."""
+    lines = []
+    line = first
+    for word in text.split(" "):
+        if line not in (first, rest) and len(line) + 1 + len(word) > width:
+            lines.append(line)
+            line = rest
+        line += word if line in (first, rest) else " " + word
+    lines.append(line)
+    return lines
+
+
+def generate_cpp():
+    out = [
+        "// Generated by tools/generate_payloads.py from tools/payloads.py, do "
+        "not edit!",
+        "#ifndef PAYLOADS_H",
+        "#define PAYLOADS_H",
+        "",
+        "#include <cmath>",
+        "#include <cstdint>",
+        "",
+        '#include "angle.h"',
+        '#include "vector.h"',
+        "",
+        f"#define FRAME_VERSION {payloads.FRAME_VERSION}",
+        "",
+        "// NULL values",
+    ]
+    width = max(len(name) for name, _, _ in payloads.CONSTANTS)
+    for name, value, _ in payloads.CONSTANTS:
+        out.append(f"#define {name.ljust(width)} {value}")
+
+    out += ["", "// Payload type IDs", "enum PayloadType : uint8_t {"]
+    for name, value, _ in payloads.PAYLOAD_TYPES:
+        out.append(f"    PAYLOAD_{name} = {value},")
+    out.append("};")
+
+    for name, (comment, fields, methods) in STRUCTS.items():
+        out.append("")
+        if comment:
+            out += wrap(comment, "// ", "// ")
+        if not fields:
+            out.append(
+                f"struct __attribute__((packed, may_alias)) {name} {{}};")
+            continue
+        out.append(f"struct __attribute__((packed, may_alias)) {name} {{")
+
+        flags = [field for field in fields if field[1] == "flag"]
+        if flags:
+            initialisers = ", ".join(f"{field[0]}({cpp_value(field[2])})"
+                                     for field in flags)
+            constructor = f"    {name}() : {initialisers} {{}}"
+            if len(constructor) > 80:
+                constructor = f"    {name}()\n" + "\n".join(
+                    wrap(initialisers + " {}", "        : ", "          "))
+            out += [constructor, ""]
+
+        lines = []
+        for group in groups(fields):
+            kind = group[0][1]
+            if kind == "flag":
+                for field_name, _, _, field_comment in group:
+                    lines.append((f"    bool {field_name} : 1;", field_comment))
+                if len(group) < 8:
+                    lines.append((f"    uint8_t : {8 - len(group)};", None))
+                continue
+            field_name, _, default, field_comment = group[0]
+            if array(kind):
+                element, length, _ = array(kind)
+                lines.append((f"    {PRIMITIVES[element][0]} {field_name}"
+                              f"[{length}] = {{}};", field_comment))
+            elif kind in PRIMITIVES:
+                lines.append((f"    {PRIMITIVES[kind][0]} {field_name} = "
+                              f"{cpp_value(default)};", field_comment))
+            else:
+                lines.append((f"    {kind} {field_name};", field_comment))
+        out += align_comments(lines)
+
+        if methods:
+            out.append("")
+            for line in methods.strip("\n").split("\n"):
+                out.append(f"    {line}" if line else "")
+        out.append("};")
+        out.append(f"static_assert(sizeof({name}) == {struct_size(name)}, "
+                   f'"{name} is padded");')
+
+    out += [
+        "",
+        "// Payload type ID of each payload struct, e.g. "
+        "PayloadTypeOf<MUXTXPayload>",
+        "template <typename Payload> struct PayloadTypeOf;",
+    ]
+    for name, _, struct_name in payloads.PAYLOAD_TYPES:
+        out += [
+            f"template <> struct PayloadTypeOf<{struct_name}> {{",
+            f"    static constexpr PayloadType value = PAYLOAD_{name};",
+            "};",
+        ]
+
+    out += ["", "#endif", ""]
+    return "\n".join(out)
+
+
+def generate_python():
+    out = [
+        "# Generated by microcontrollers/tools/generate_payloads.py from",
+        "# microcontrollers/tools/payloads.py, do not edit!",
+        "import struct",
+        "from dataclasses import dataclass, field",
+        "",
+        f"FRAME_VERSION = {payloads.FRAME_VERSION}",
+        "",
+        "# NULL values",
+    ]
+    for name, _, value in payloads.CONSTANTS:
+        out.append(f"{name} = {value:#x}")
+
+    out += ["", "# Payload type IDs"]
+    for name, value, _ in payloads.PAYLOAD_TYPES:
+        out.append(f"PAYLOAD_{name} = {value}")
+
+    for name, (comment, fields, _) in STRUCTS.items():
+        out += ["", "", "@dataclass", f"class {name}:"]
+        if comment:
+            out += wrap(f'"""{comment}."""', "    ", "    ", 88)
+            out.append("")
+
+        for field_name, kind, default, field_comment in fields:
+            attribute = snake_case(field_name)
+            if kind == "flag":
+                line = f"    {attribute}: bool = {default}"
+            elif array(kind):
+                _, length, _ = array(kind)
+                line = (f"    {attribute}: list = "
+                        f"field(default_factory=lambda: [0] * {length})")
+            elif kind in PRIMITIVES:
+                annotation = "float" if kind == "float" else "int"
+                if kind == "float" and isinstance(default, int):
+                    default = float(default)
+                line = f"    {attribute}: {annotation} = {python_value(default)}"
+            else:
+                line = f"    {attribute}: {kind} = field(default_factory={kind})"
+            if field_comment:
+                line += f"  # {field_comment}"
+            out.append(line)
+
+        fmt = struct_format(name)
+        out += [
+            "",
+            f'    FORMAT = "<{fmt}"',
+            f"    SIZE = {struct_size(name)}",
+            "",
+            "    def pack(self) -> bytes:",
+            "        return struct.pack(self.FORMAT, *self.values())",
+            "",
+            "    @classmethod",
+            f'    def unpack(cls, buf: bytes) -> "{name}":',
+            "        return cls.from_values(iter(struct.unpack(cls.FORMAT, "
+            "buf)))",
+            "",
+            "    def values(self) -> list:",
+        ]
+        if not fields:
+            out.append("        return []")
+        else:
+            out.append("        return [")
+            for group in groups(fields):
+                kind = group[0][1]
+                if kind == "flag":
+                    bits = " | ".join(f"self.{snake_case(f[0])} << {i}"
+                                      for i, f in enumerate(group))
+                    out.append(f"            {bits},")
+                elif array(kind):
+                    out.append(f"            *self.{snake_case(group[0][0])},")
+                elif kind in PRIMITIVES:
+                    out.append(f"            self.{snake_case(group[0][0])},")
+                else:
+                    out.append(
+                        f"            *self.{snake_case(group[0][0])}.values(),")
+            out.append("        ]")
+
+        out += [
+            "",
+            "    @classmethod",
+            f'    def from_values(cls, values) -> "{name}":',
+        ]
+        # Read each group where it is in the values, then build the struct
+        arguments = []
+        for index, group in enumerate(groups(fields)):
+            kind = group[0][1]
+            attribute = snake_case(group[0][0])
+            if kind == "flag":
+                out.append(f"        flags{index} = next(values)")
+                for bit, f in enumerate(group):
+                    arguments.append(
+                        f"{snake_case(f[0])}=bool(flags{index} >> {bit} & 1)")
+                continue
+            if array(kind):
+                _, length, _ = array(kind)
+                value = f"[next(values) for _ in range({length})]"
+            elif kind in PRIMITIVES:
+                value = "next(values)"
+            else:
+                value = f"{kind}.from_values(values)"
+            out.append(f"        {attribute}_ = {value}")
+            arguments.append(f"{attribute}={attribute}_")
+        if arguments:
+            out.append("        return cls(")
+            for argument in arguments:
+                out.append(f"            {argument},")
+            out.append("        )")
+        else:
+            out.append("        return cls()")
+
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    check = "--check" in sys.argv[1:]
+    stale = False
+    for path, contents in ((CPP_PATH, generate_cpp()),
+                           (PYTHON_PATH, generate_python())):
+        if path.exists() and path.read_text() == contents:
+            continue
+        stale = True
+        if check:
+            print(f"{path} is out of date", file=sys.stderr)
+        else:
+            path.write_text(contents)
+            print(f"Wrote {path}")
+    return 1 if check and stale else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,346 @@
+# Wire format of every payload sent over the serial links, shared by the
+# microcontrollers and the Coral. After editing, run
+#   python3 tools/generate_payloads.py
+# to regenerate include/payloads.h and coral/server/camera/payloads.py.
+#
+# Structs are packed, so fields are laid out exactly as listed (little endian),
+# and may alias a buffer so that they can be read in place.
+# Consecutive flags share a byte, the first flag being the least significant
+# bit. Field types are int8/uint8/int16/uint16/int32/uint32/float, arrays of
+# them (like "uint16[30]", which default to zeros), "flag" or the name of a
+# struct defined above. Defaults are numbers, booleans or the names of
+# constants. Remember to bump FRAME_VERSION whenever a layout changes!
+
+FRAME_VERSION = 9
+
+# (name, C++ value, Python value)
+CONSTANTS = [
+    ("NO_LINE_INT16", "INT16_MAX", 0x7FFF),
+    ("NO_LINE_UINT8", "UINT8_MAX", 0xFF),
+    ("NO_CROSSING", "UINT16_MAX", 0xFFFF),
+    ("NO_ANGLE", "INT16_MAX", 0x7FFF),
+    ("NO_BOUNDS", "UINT16_MAX", 0xFFFF),
+    ("NO_BALL_INT16", "INT16_MAX", 0x7FFF),
+    ("NO_BALL_UINT16", "UINT16_MAX", 0xFFFF),
+    ("MUX_COMMAND_NONE", "0", 0),
+    ("MUX_COMMAND_CALIBRATE", "1", 1),
+    ("MUX_COMMAND_WRITE_PARAMETERS", "2", 2),
+    ("MUX_COMMAND_SAVE_PARAMETERS", "3", 3),
+    ("MUX_PARAMETER_CHUNK_SIZE", "16", 16),
+    ("LDR_FILTER_K_OF_N", "0", 0),
+    ("LDR_FILTER_HYSTERESIS", "1", 1),
+    ("MUX_LDR_COUNT", "30", 30),
+    ("LDR_INTENSITY_BLOCK_SIZE", "8", 8),
+    ("LDR_INTENSITY_MAX", "14", 14),
+    ("NO_LDR_INTENSITY", "15", 15),
+    ("LINK_TEST_PING", "1", 1),
+    ("LINK_TEST_SWITCH", "2", 2),
+    ("LINK_TEST_PATTERN", "3", 3),
+    ("LINK_TEST_COMMIT", "4", 4),
+    ("LINK_TEST_END", "5", 5),
+    ("LINK_TEST_PATTERN_SIZE", "32", 32),
+]
+
+# Sent by the STM32 MUX in both MUXTXPayload and MUXLDRTXPayload
+MUX_TX_FIELDS = [
+    ("header", "PacketHeader", None, None),
+    ("line", "LineData", None, None),
+    ("commandId", "uint8", 0, "of the last command carried out, 0 if none"),
+    ("commandFailed", "flag", False, None),
+    ("thresholdDrift", "int16", 0, "in ADC counts, see adaptLDRLevels()"),
+    ("thresholdDriftLDR", "uint8", 0, "whose threshold drifted most"),
+]
+
+# Raw sensor data, and the payloads that carry it. Each struct is
+#   (name, comment, [(field, type, default, comment), ...], C++ methods)
+STRUCTS = [
+    (
+        "PacketHeader",
+        "Every payload sent to the Teensy starts with this header, so that it "
+        "can tell new packets from repeated or reordered ones and how old "
+        "their data is",
+        [
+            ("time", "uint32", 0, "sender's micros() when the data was read"),
+            ("sequence", "uint16", 0, "incremented for every packet, rolls over"),
+        ],
+        """
+void advance(uint32_t now) {
+    time = now;
+    ++sequence;
+}
+""",
+    ),
+    (
+        "LineData",
+        None,
+        [
+            ("newData", "flag", True, None),
+            ("angleBisector", "int16", "NO_LINE_INT16", "-179(.)99° to 180(.)00°"),
+            ("size", "uint8", "NO_LINE_UINT8", "0(.)00 to 1(.)00"),
+            ("confidence", "uint8", 0, "0(.)00 to 1(.)00"),
+            ("sizeRate", "int16", 0, "-327(.)68/s to 327(.)67/s"),
+            ("angleRate", "int16", 0, "-3276(.)8°/s to 3276(.)7°/s"),
+            ("timeToCross", "uint16", "NO_CROSSING", "in ms, until size is 1"),
+        ],
+        """
+bool exists() {
+    return angleBisector != NO_LINE_INT16 && size != NO_LINE_UINT8;
+}
+""",
+    ),
+    (
+        "LDRData",
+        "Which LDRs are on the line, and how strongly a block of them sees it "
+        "(the blocks take turns, so each intensity is only sent every few "
+        "packets)",
+        [
+            ("activations", "uint32", 0, "bit i is set if LDR i is on the line"),
+            ("intensityBlock", "uint8", 0, "of LDR_INTENSITY_BLOCK_SIZE LDRs"),
+            ("intensities", "uint8[4]", None, "two per byte, low nibble first"),
+        ],
+        """
+// Intensity of LDR i of the block, from 0 (field) to LDR_INTENSITY_MAX
+// (line), or NO_LDR_INTENSITY if it hasn't been calibrated
+uint8_t intensity(uint8_t i) const {
+    return intensities[i / 2] >> (i % 2 * 4) & 0xF;
+}
+
+void setIntensity(uint8_t i, uint8_t value) {
+    intensities[i / 2] &= 0xF0 >> (i % 2 * 4);
+    intensities[i / 2] |= (value & 0xF) << (i % 2 * 4);
+}
+""",
+    ),
+    (
+        "IMUData",
+        None,
+        [
+            ("newData", "flag", True, None),
+            ("robotAngle", "int16", "NO_ANGLE", "-179(.)99º to +180(.)00º"),
+        ],
+        None,
+    ),
+    (
+        "BoundsData",
+        None,
+        [
+            ("frontNewData", "flag", True, None),
+            ("backNewData", "flag", True, None),
+            ("leftNewData", "flag", True, None),
+            ("rightNewData", "flag", True, None),
+            ("front", "uint16", "NO_BOUNDS", "0(.)0 cm to 400(.)0 cm"),
+            ("back", "uint16", "NO_BOUNDS", "0(.)0 cm to 400(.)0 cm"),
+            ("left", "uint16", "NO_BOUNDS", "0(.)0 cm to 400(.)0 cm"),
+            ("right", "uint16", "NO_BOUNDS", "0(.)0 cm to 400(.)0 cm"),
+        ],
+        """
+void set(uint8_t index, uint16_t value = NO_BOUNDS) {
+    switch (index) {
+    case 0:
+        front = value;
+        frontNewData = value != NO_BOUNDS;
+        break;
+    case 1:
+        back = value;
+        backNewData = value != NO_BOUNDS;
+        break;
+    case 2:
+        left = value;
+        leftNewData = value != NO_BOUNDS;
+        break;
+    case 3:
+        right = value;
+        rightNewData = value != NO_BOUNDS;
+        break;
+    }
+}
+
+void markAsOld() {
+    frontNewData = false;
+    backNewData = false;
+    leftNewData = false;
+    rightNewData = false;
+}
+""",
+    ),
+    (
+        "CameraData",
+        None,
+        [
+            ("newData", "flag", True, None),
+            ("ballAngle", "int16", "NO_BALL_INT16", "-179(.)99° to 180(.)00°"),
+            ("ballDistance", "uint16", "NO_BALL_UINT16", "0(.)0 cm to ~400(.)0 cm"),
+            ("blueGoalAngle", "int16", "NO_BALL_INT16", "-179(.)99° to 180(.)00°"),
+            ("blueGoalDistance", "uint16", "NO_BALL_UINT16", "0(.)0 cm to ~400(.)0 cm"),
+            ("yellowGoalAngle", "int16", "NO_BALL_INT16", "-179(.)99° to 180(.)00°"),
+            ("yellowGoalDistance", "uint16", "NO_BALL_UINT16", "0(.)0 cm to ~400(.)0 cm"),
+        ],
+        None,
+    ),
+    (
+        "BluetoothPayload",
+        "This should be symmetric",
+        [
+            ("newData", "flag", True, None),
+            ("masterIsStriker", "flag", True, None),
+            ("ballAngle", "float", float("nan"), "relative to field center"),
+            ("ballDistance", "float", float("nan"), None),
+            ("robotAngle", "float", float("nan"), "relative to field center"),
+            ("robotDistance", "float", float("nan"), None),
+        ],
+        """
+Vector ball() const { return {ballAngle, ballDistance}; }
+Vector robot() const { return {robotAngle, robotDistance}; }
+
+// Creates a new BluetoothPayload with newData set as true
+static BluetoothPayload create(bool masterIsStriker, Vector ball,
+                               Vector robot) {
+    BluetoothPayload newPayload;
+    newPayload.newData = true;
+    newPayload.masterIsStriker = masterIsStriker;
+    newPayload.ballAngle = ball.angle;
+    newPayload.ballDistance = ball.distance;
+    newPayload.robotAngle = robot.angle;
+    newPayload.robotDistance = robot.distance;
+    return newPayload;
+}
+""",
+    ),
+    (
+        "MUXParameters",
+        "Parameters of the STM32 MUX that can be changed without reflashing it",
+        [
+            ("ldrThresholds", "uint16[30]", None, "one for each LDR"),
+            ("activationThreshold", "uint16", 0, "in scans, see ldr_filter.h"),
+            ("calibrationMultiplier", "float", 0, "0 (green) to 1 (white)"),
+            ("ldrFieldValues", "uint16[30]", None, "green, one for each LDR"),
+            ("ldrLineValues", "uint16[30]", None, "white, one for each LDR"),
+            ("analogLineEstimation", "uint8", 0, "0 or 1, see findLine()"),
+            ("adaptiveThresholds", "uint8", 0, "0 or 1, see adaptLDRLevels()"),
+            ("ldrFilter", "uint8", "LDR_FILTER_K_OF_N", "see ldr_filter.h"),
+            ("ldrFilterWindow", "uint8", 0, "in scans"),
+            ("deactivationThreshold", "uint8", 0, "in scans, for hysteresis"),
+        ],
+        None,
+    ),
+    (
+        "MUXTXPayload",
+        None,
+        MUX_TX_FIELDS,
+        None,
+    ),
+    (
+        "MUXLDRTXPayload",
+        "Sent by the STM32 MUX instead of MUXTXPayload with MUX_LDR_DATA (see "
+        "shared_config.h)",
+        MUX_TX_FIELDS + [("ldrs", "LDRData", None, None)],
+        None,
+    ),
+    (
+        "MUXRXPayload",
+        "A command for the STM32 MUX, which carries it out once for each "
+        "commandId and acknowledges it in MUXTXPayload. Parameters are "
+        "uploaded as chunks of MUXParameters, then saved.",
+        [
+            ("command", "uint8", "MUX_COMMAND_NONE", None),
+            ("commandId", "uint8", 0, "1 to 255, as 0 means none"),
+            ("offset", "uint8", 0, "of data in MUXParameters, in bytes"),
+            ("data", "uint8[MUX_PARAMETER_CHUNK_SIZE]", None, None),
+        ],
+        None,
+    ),
+    (
+        "IMUTXPayload",
+        None,
+        [
+            ("header", "PacketHeader", None, None),
+            ("imu", "IMUData", None, None),
+        ],
+        None,
+    ),
+    (
+        "IMURXPayload",
+        None,
+        [
+            ("calibrating", "flag", False, None),
+        ],
+        None,
+    ),
+    (
+        "TOFTXPayload",
+        None,
+        [
+            ("header", "PacketHeader", None, None),
+            ("bounds", "BoundsData", None, None),
+            ("bluetoothInboundPayload", "BluetoothPayload", None, None),
+        ],
+        None,
+    ),
+    (
+        "TOFRXPayload",
+        None,
+        [
+            ("bluetoothOutboundPayload", "BluetoothPayload", None, None),
+        ],
+        None,
+    ),
+    (
+        "CoralTXPayload",
+        None,
+        [
+            ("header", "PacketHeader", None, None),
+            ("camera", "CameraData", None, None),
+        ],
+        None,
+    ),
+    (
+        "CoralRXPayload",
+        "Sent to the Coral at a fixed rate so that it can compensate its "
+        "tracking for the robot's own motion",
+        [
+            ("heading", "int16", "NO_ANGLE", "-179(.)99° to 180(.)00°"),
+            ("headingRate", "int16", 0, "-3276(.)8°/s to 3276(.)7°/s"),
+            ("movementAngle", "int16", 0, "-179(.)99° to 180(.)00°, relative"),
+            ("movementVelocity", "int16", 0, "±35 to ±1023, 0 to stop"),
+        ],
+        """
+// heading and rate in º and º/s
+void setHeading(float heading, float rate) {
+    this->heading = BinaryAngle::fromDegrees(heading).centidegrees();
+    headingRate = roundf(fminf(fmaxf(rate * 10, INT16_MIN), INT16_MAX));
+}
+
+// angle in º relative to the front of the robot, as in Movement
+void setMovement(float angle, int16_t velocity) {
+    movementAngle = BinaryAngle::fromDegrees(angle).centidegrees();
+    movementVelocity = velocity;
+}
+""",
+    ),
+    (
+        "LinkTestPayload",
+        "Sent by the Teensy to negotiate the baud rate of a link, and echoed "
+        "back by the STM32 (see link_test.h)",
+        [
+            ("command", "uint8", "LINK_TEST_PING", None),
+            ("sequence", "uint16", 0, None),
+            ("baudRate", "uint32", 0, "to switch to"),
+            ("pattern", "uint8[LINK_TEST_PATTERN_SIZE]", None, None),
+        ],
+        None,
+    ),
+]
+
+# (name, ID, struct), one for each payload sent over the serial links
+PAYLOAD_TYPES = [
+    ("MUX_TX", 1, "MUXTXPayload"),
+    ("MUX_RX", 2, "MUXRXPayload"),
+    ("IMU_TX", 3, "IMUTXPayload"),
+    ("IMU_RX", 4, "IMURXPayload"),
+    ("TOF_TX", 5, "TOFTXPayload"),
+    ("TOF_RX", 6, "TOFRXPayload"),
+    ("CORAL_TX", 7, "CoralTXPayload"),
+    ("CORAL_RX", 8, "CoralRXPayload"),
+    ("LINK_TEST", 9, "LinkTestPayload"),
+    ("MUX_LDR_TX", 10, "MUXLDRTXPayload"),
+]
@@ -0,0 +1,180 @@
+"""Decodes the Teensy's binary telemetry stream (see include/telemetry.h) to CSV.
+
+Usage:
+    python3 telemetry.py /dev/ttyACM0 match       # record from the Teensy
+    python3 telemetry.py capture.bin match        # decode a raw capture
+
+This writes match_sensors.csv, match_movement.csv and match_pid.csv, with one
+row per record and empty cells for missing values.
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+
+from cobs import cobs
+from serial import Serial
+
+
+# Keep in sync with include/telemetry.h!
+HEADER = struct.Struct("<BI")  # type, time (µs)
+INT16_NONE = 2**15 - 1
+UINT16_NONE = 2**16 - 1
+
+# Keep in sync with TELEMETRY_PID_* in src/teensy/include/config.h!
+PID_NAMES = {
+    0: "heading",
+    1: "move_to",
+    2: "line_track",
+    3: "move_on_line_to_ball",
+}
+
+
+def scaled(scale, none=None):
+    """Returns a converter that divides by scale, or maps none to no value."""
+    return lambda value: None if value == none else value / scale
+
+
+def pid_name(value):
+    return PID_NAMES.get(value, value)
+
+
+# type: (name, layout, [(column, converter)])
+RECORDS = {
+    1: (
+        "sensors",
+        struct.Struct("<hhhhBHHHHhHhHhH??"),
+        [
+            ("robot_angle", scaled(100, INT16_NONE)),  # º
+            ("robot_x", scaled(10, INT16_NONE)),  # cm
+            ("robot_y", scaled(10, INT16_NONE)),  # cm
+            ("line_angle_bisector", scaled(100, INT16_NONE)),  # º
+            ("line_depth", scaled(100)),
+            ("bound_front", scaled(10, UINT16_NONE)),  # cm
+            ("bound_back", scaled(10, UINT16_NONE)),  # cm
+            ("bound_left", scaled(10, UINT16_NONE)),  # cm
+            ("bound_right", scaled(10, UINT16_NONE)),  # cm
+            ("ball_angle", scaled(100, INT16_NONE)),  # º
+            ("ball_distance", scaled(10, UINT16_NONE)),  # cm
+            ("offensive_goal_angle", scaled(100, INT16_NONE)),  # º
+            ("offensive_goal_distance", scaled(10, UINT16_NONE)),  # cm
+            ("defensive_goal_angle", scaled(100, INT16_NONE)),  # º
+            ("defensive_goal_distance", scaled(10, UINT16_NONE)),  # cm
+            ("has_ball", int),
+            ("master_is_striker", int),
+        ],
+    ),
+    2: (
+        "movement",
+        struct.Struct("<hhhhh??"),
+        [
+            ("angle", scaled(100)),  # º
+            ("velocity", int),
+            ("heading", scaled(100)),  # º
+            ("actual_heading", scaled(100)),  # º
+            ("angular_velocity", int),
+            ("dribble", int),
+            ("brake", int),
+        ],
+    ),
+    3: (
+        "pid",
+        struct.Struct("<BfffffffI"),
+        [
+            ("controller", pid_name),
+            ("setpoint", float),
+            ("input", float),
+            ("error", float),
+            ("output", float),
+            ("p", float),
+            ("i", float),
+            ("d", float),
+            ("dt", int),  # µs
+        ],
+    ),
+}
+
+
+class TelemetryDecoder:
+    def __init__(self, prefix: str) -> None:
+        self._files = []
+        self._writers = {}
+        for record_type, (name, _, columns) in RECORDS.items():
+            file = open(f"{prefix}_{name}.csv", "w", newline="")
+            writer = csv.writer(file)
+            writer.writerow(["time"] + [column for column, _ in columns])
+            self._files.append(file)
+            self._writers[record_type] = writer
+        self._buffer = bytearray()
+        self.counts = {name: 0 for name, _, _ in RECORDS.values()}
+        self.invalid = 0
+
+    def close(self) -> None:
+        for file in self._files:
+            file.close()
+
+    def feed(self, data: bytes) -> None:
+        """Decodes every complete frame in data, keeping partial ones."""
+        self._buffer += data
+        *frames, self._buffer = self._buffer.split(b"\x00")
+        for frame in frames:
+            if frame:
+                self._decode(bytes(frame))
+
+    def _decode(self, frame: bytes) -> None:
+        # Drop anything that isn't a valid record, e.g. text printed by the
+        # Teensy or a frame cut off when we started reading
+        try:
+            frame = cobs.decode(frame)
+        except cobs.DecodeError:
+            self.invalid += 1
+            return
+        if len(frame) < HEADER.size or frame[0] not in RECORDS:
+            self.invalid += 1
+            return
+        record_type, time = HEADER.unpack_from(frame)
+        name, layout, columns = RECORDS[record_type]
+        if len(frame) != HEADER.size + layout.size:
+            self.invalid += 1
+            return
+
+        values = layout.unpack_from(frame, HEADER.size)
+        row = [time] + [
+            convert(value) for (_, convert), value in zip(columns, values)
+        ]
+        self._writers[record_type].writerow(row)
+        self.counts[name] += 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", help="serial device or raw capture file")
+    parser.add_argument("prefix", help="prefix of the CSV files to write")
+    args = parser.parse_args()
+
+    decoder = TelemetryDecoder(args.prefix)
+    try:
+        if os.path.isfile(args.source):
+            with open(args.source, "rb") as file:
+                while data := file.read(4096):
+                    decoder.feed(data)
+        else:
+            # Record until interrupted
+            serial = Serial(args.source, timeout=0.1)
+            while True:
+                decoder.feed(serial.read(max(1, serial.in_waiting)))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        decoder.close()
+        print(
+            ", ".join(f"{count} {name}" for name, count in decoder.counts.items())
+            + f" records, {decoder.invalid} invalid frames",
+            file=sys.stderr,
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Checks that every generated Python payload unpacks to what it was packed
+from, with its defaults and with a distinct value in every field.
+
+Usage: python3 tools/test_payloads.py
+"""
+import dataclasses
+import importlib.util
+import itertools
+import unittest
+from pathlib import Path
+
+# Loaded by path, as the camera package needs the Coral's dependencies and
+# tools/payloads.py has the same name
+PATH = Path(__file__).resolve().parents[2] / "coral/server/camera/payloads.py"
+SPEC = importlib.util.spec_from_file_location("generated_payloads", PATH)
+payloads = importlib.util.module_from_spec(SPEC)
+SPEC.loader.exec_module(payloads)
+
+STRUCTS = [
+    value
+    for value in vars(payloads).values()
+    if dataclasses.is_dataclass(value) and hasattr(value, "FORMAT")
+]
+
+
+def distinct(cls, counter):
+    """Returns an instance of cls with a different value in every field, small
+    enough for any of them (and exact as a float), so that fields decoded out
+    of order don't compare equal."""
+    values = {}
+    for field in dataclasses.fields(cls):
+        default = getattr(cls(), field.name)
+        if isinstance(default, bool):
+            values[field.name] = next(counter) % 2 == 0
+        elif isinstance(default, float):
+            values[field.name] = next(counter) % 100 + 0.5
+        elif isinstance(default, int):
+            values[field.name] = next(counter) % 100 + 1
+        elif isinstance(default, list):
+            values[field.name] = [next(counter) % 100 + 1 for _ in default]
+        else:
+            values[field.name] = distinct(type(default), counter)
+    return cls(**values)
+
+
+class RoundTripTest(unittest.TestCase):
+    def test_defaults(self):
+        for cls in STRUCTS:
+            with self.subTest(cls.__name__):
+                self.assertEqual(len(cls().pack()), cls.SIZE)
+                # By repr, as NaNs never compare equal
+                self.assertEqual(repr(cls.unpack(cls().pack())), repr(cls()))
+
+    def test_distinct_values(self):
+        for cls in STRUCTS:
+            with self.subTest(cls.__name__):
+                payload = distinct(cls, itertools.count())
+                self.assertEqual(cls.unpack(payload.pack()), payload)
+
+
+if __name__ == "__main__":
+    unittest.main()